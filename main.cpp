@@ -4,10 +4,57 @@
 #include <chrono>
 #include <string>
 #include <sstream>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <future>
+#include <deque>
+#include <random>
+#include <functional>
+#include <climits>
+#include <queue>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <glob.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OSOMS_X86_SIMD 1
+#include <immintrin.h>
+#endif
 
 using namespace std;
 using namespace chrono;
 
+// Money is held as a whole number of cents (sen), so parsing, comparing
+// and summing prices are exact integer operations
+typedef long long Money;
+const Money CENTS_PER_RINGGIT = 100;
+
 // Order structure with phone number
 struct Order {
     int orderID;              // 1. Order ID
@@ -16,8 +63,8 @@ struct Order {
     string productName;       // 4. Product Name
     string productCategory;   // 5. Product Category (for reports only)
     int quantity;             // 6. Quantity
-    double unitPrice;         // 7. Unit Price
-    double totalAmount;       // 8. Total Amount (from file)
+    Money unitPrice;          // 7. Unit Price (cents)
+    Money totalAmount;        // 8. Total Amount (cents, from file)
     Order* next;              // For linked list
     
     Order() : next(nullptr) {}
@@ -25,16 +72,587 @@ struct Order {
 
 // Global variables
 Order* orderList = nullptr;
+Order* orderTail = nullptr;        // last node, so appends do not walk the list
 int orderCount = 0;
 const int MAX_ORDERS = 10000;
 const int DISPLAY_LIMIT = 100;
 
+// Bumped whenever the set of Order nodes changes (load/free) so that
+// derived structures such as the range indexes know to rebuild
+int dataVersion = 0;
+// Bumped whenever the list order changes (sort/load/free) so that
+// position-based structures such as the scan columns know to rebuild
+int layoutVersion = 0;
+
 // Sorting statistics
 struct SortStats {
     long long swapCount;
     double executionTime;
 };
 
+// A saved list order. Nodes are never copied: restoring relinks the same
+// nodes in the saved order, which is valid while dataVersion is unchanged.
+struct OrderSnapshot {
+    vector<Order*> order;
+    int dataVersion;
+    double takenAt;           // ms since program start, for display
+    
+    OrderSnapshot() : dataVersion(-1), takenAt(0) {}
+};
+
+OrderSnapshot savedSnapshot;
+
+// Columns supported by range queries
+enum RangeColumn {
+    RANGE_TOTAL_AMOUNT = 0,
+    RANGE_UNIT_PRICE = 1,
+    RANGE_QUANTITY = 2,
+    RANGE_COLUMN_COUNT = 3
+};
+
+// Sorted-array index over one numeric column, keyed in the column's own
+// units (cents for money, items for quantity).
+// rows/keys are sorted ascending by key; the prefix sums let a range
+// return its count and sums in O(log n) and its rows in O(log n + k).
+struct RangeIndex {
+    vector<Order*> rows;
+    vector<long long> keys;
+    vector<long long> keyPrefix;  // keyPrefix[i] = keys[0] + ... + keys[i-1]
+    vector<Money> amountPrefix;   // same, over totalAmount
+    vector<Order*> pending;       // ingested since the last merge; counted in builtVersion
+    int builtVersion;
+    double buildTime;
+
+    RangeIndex() : builtVersion(-1), buildTime(0) {}
+};
+
+RangeIndex rangeIndexes[RANGE_COLUMN_COUNT];
+const int RANGE_PAGE_SIZE = 20;
+
+// Numeric columns copied out of the linked list in list order, so the
+// scan kernels can stream over contiguous memory instead of chasing next
+struct OrderColumns {
+    vector<Order*> rows;
+    vector<int> orderID;
+    vector<int> quantity;
+    vector<Money> unitPrice;
+    vector<Money> totalAmount;
+    int builtVersion;
+    
+    OrderColumns() : builtVersion(-1) {}
+};
+
+OrderColumns scanColumns;
+
+// Rows grouped by productCategory, each group with its own scan columns
+// and aggregates, so category reports, searches and sorts touch only the
+// rows of that category. Categories are discovered from the data.
+struct CategoryPartition {
+    string name;
+    OrderColumns columns;     // this category's rows, in list order
+    long long quantitySum;
+    Money salesSum;
+    Money minAmount;
+    Money maxAmount;
+};
+
+struct CategoryPartitions {
+    vector<CategoryPartition> partitions;   // in order of first appearance
+    int builtVersion;
+    double buildTime;
+    
+    CategoryPartitions() : builtVersion(-1), buildTime(0) {}
+};
+
+CategoryPartitions categoryPartitions;
+
+// One implementation tier of the scan kernels (scalar, SSE4.1 or AVX2)
+struct ScanKernels {
+    const char* name;
+    int (*findInt32)(const int* data, int n, int start, int value);
+    int (*countRangeInt32)(const int* data, int n, int lo, int hi);
+    void (*sumMinMaxInt64)(const long long* data, int n, long long& sum, long long& minValue, long long& maxValue);
+};
+
+// Blocked Bloom filter over (orderID, customerName). Each key maps to one
+// 512-bit block (a cache line) and sets hashCount bits inside it, so a
+// probe touches a single cache line.
+struct BloomFilter {
+    vector<uint64_t> words;      // BLOOM_BLOCK_WORDS words per block
+    size_t blockCount;
+    int hashCount;
+    size_t capacity;             // item count the filter was sized for
+    size_t itemCount;
+    long long probes;
+    long long rejects;           // answered "definitely not present"
+    long long passes;            // answered "maybe present"
+    long long falsePositives;    // passed but the scan found nothing
+    
+    BloomFilter() : blockCount(0), hashCount(0), capacity(0), itemCount(0),
+                    probes(0), rejects(0), passes(0), falsePositives(0) {}
+};
+
+const int BLOOM_BLOCK_WORDS = 8;
+BloomFilter orderBloom;
+double bloomTargetFpr = 0.01;
+
+// Output buffer for table pages. Rows are formatted straight into one
+// preallocated char buffer and written to cout with a single call.
+struct TableRenderer {
+    vector<char> buffer;
+    size_t length;
+    
+    TableRenderer() : length(0) {}
+};
+
+const int TABLE_ROW_WIDTH = 121;    // one displayOrder row, newline included
+const int BROWSE_PAGE_SIZE = 50;
+const char* TABLE_RULE = "========================================================================================================================\n";
+
+// Instrumentation: monotonic counters and named timers shared by the
+// load, sort, search and report paths, shown in the Stats menu
+enum StatCounter {
+    STAT_ROWS_PARSED = 0,
+    STAT_COMPARISONS,
+    STAT_SWAPS,
+    STAT_INDEX_PROBES,
+    STAT_ALLOCATIONS,
+    STAT_COUNTER_COUNT
+};
+
+const char* STAT_COUNTER_NAMES[STAT_COUNTER_COUNT] = {
+    "rows_parsed", "comparisons", "swaps", "index_probes", "allocations"
+};
+
+enum StatTimer {
+    TIMER_LOAD = 0,
+    TIMER_INSERTION_SORT,
+    TIMER_QUICK_SORT,
+    TIMER_PARALLEL_SORT,
+    TIMER_LINEAR_SEARCH,
+    TIMER_BINARY_SEARCH,
+    TIMER_SENTINEL_SEARCH,
+    TIMER_SIMD_SEARCH,
+    TIMER_RANGE_QUERY,
+    TIMER_INDEX_BUILD,
+    TIMER_TOTAL_SALES,
+    TIMER_QUANTITY_REPORT,
+    TIMER_CATEGORY_REPORT,
+    TIMER_RENDER,
+    TIMER_FIRST_MENU,
+    TIMER_PARTITION_BUILD,
+    TIMER_CATEGORY_SEARCH,
+    TIMER_CATEGORY_SORT,
+    TIMER_SHARD_LOAD,
+    TIMER_SHARD_MERGE,
+    TIMER_EXTERNAL_SORT,
+    TIMER_SKETCH_BUILD,
+    TIMER_INGEST_APPLY,
+    TIMER_QUERY,
+    TIMER_COUNT
+};
+
+const char* STAT_TIMER_NAMES[TIMER_COUNT] = {
+    "load", "insertion_sort", "quick_sort", "parallel_quick_sort",
+    "linear_search", "binary_search", "sentinel_search", "simd_search",
+    "range_query", "range_index_build", "report_total_sales",
+    "report_quantity", "report_category", "render_table",
+    "time_to_first_menu", "category_partition_build",
+    "category_search", "category_sort",
+    "shard_load", "shard_merge", "external_sort",
+    "sketch_build", "ingest_apply", "query"
+};
+
+// Hardware events read through perf_event_open (Linux only)
+enum HardwareEvent {
+    HW_CYCLES = 0,
+    HW_CACHE_MISSES,
+    HW_BRANCH_MISSES,
+    HW_EVENT_COUNT
+};
+
+const char* HW_EVENT_NAMES[HW_EVENT_COUNT] = {"cycles", "cache_misses", "branch_misses"};
+
+struct TimerStats {
+    atomic<long long> calls;
+    atomic<long long> totalNanos;
+    atomic<long long> maxNanos;
+    atomic<long long> hardware[HW_EVENT_COUNT];
+};
+
+// The counters count the thread that opened them (the menu thread), so
+// only timers running on that thread read them
+struct HardwareCounters {
+    int leaderFd;
+    int fds[HW_EVENT_COUNT];
+    thread::id owner;           // thread the counters measure
+    atomic<bool> enabled;       // user switched hardware counters on
+    atomic<bool> available;     // perf_event_open succeeded
+    string error;
+    
+    HardwareCounters() : leaderFd(-1), enabled(false), available(false) {}
+};
+
+atomic<long long> statCounters[STAT_COUNTER_COUNT];
+TimerStats statTimers[TIMER_COUNT];
+HardwareCounters hardwareCounters;
+
+// Times a scope and adds it to a named timer; stop() ends it early and
+// returns the elapsed milliseconds for the caller's own report
+struct ScopedTimer {
+    StatTimer timer;
+    high_resolution_clock::time_point start;
+    long long hardwareStart[HW_EVENT_COUNT];
+    bool readHardware;
+    bool stopped;
+    double elapsedMs;
+    
+    explicit ScopedTimer(StatTimer id);
+    ~ScopedTimer();
+    double stop();
+};
+
+// Block-compressed numeric columns. Each block of COLUMN_BLOCK_SIZE values
+// is stored frame-of-reference (value - block min) and bit-packed at the
+// width of (max - min). The block min/max double as a zone map, so range
+// filters skip blocks that cannot match. Money is stored as whole cents.
+// The query engine reads the zone maps to skip batches and answers
+// single-range COUNT/SUM queries from the packed blocks.
+const int COLUMN_BLOCK_SIZE = 1024;
+
+struct PackedBlock {
+    long long minValue;     // zone map, also the frame of reference
+    long long maxValue;
+    int bitWidth;
+    int count;
+    size_t wordOffset;      // first word of this block in PackedColumn::words
+};
+
+struct PackedColumn {
+    vector<PackedBlock> blocks;
+    vector<uint64_t> words;
+};
+
+struct CompressedOrderStore {
+    PackedColumn orderID;
+    PackedColumn quantity;
+    PackedColumn unitPrice;
+    PackedColumn totalAmount;
+    int builtVersion;
+    double buildTime;
+    
+    CompressedOrderStore() : builtVersion(-1), buildTime(0) {}
+};
+
+CompressedOrderStore compressedStore;
+
+struct CompressedScanResult {
+    long long matches;
+    long long sum;          // in the summed column's stored units
+    int blocksScanned;
+    int blocksSkipped;      // ruled out by the zone map
+    int blocksFullMatch;    // zone map proved every row matches
+};
+
+// Startup loading in the background: the loader thread queues parsed
+// batches and the menu thread links them between actions
+struct BackgroundLoad {
+    thread worker;
+    mutex lock;
+    vector<vector<Order*> > ready;   // parsed, not yet linked into the list
+    atomic<bool> active;
+    atomic<bool> done;
+    atomic<bool> cancel;
+    atomic<long long> bytesRead;
+    atomic<long long> rowsParsed;
+    long long totalBytes;
+    double elapsedMs;
+    high_resolution_clock::time_point startTime;
+    
+    BackgroundLoad() : active(false), done(false), cancel(false), bytesRead(0),
+                       rowsParsed(0), totalBytes(0), elapsedMs(0) {}
+};
+
+const size_t BACKGROUND_CHUNK_BYTES = 1 << 20;
+BackgroundLoad backgroundLoad;
+high_resolution_clock::time_point programStart;
+double timeToFirstMenu = -1;
+
+// One input file of a sharded load
+struct ShardLoad {
+    string path;
+    vector<Order*> orders;    // in file order
+    long long bytes;
+    double loadTime;          // read + parse, ms
+    bool opened;
+    bool sorted;              // already in compareOrders order
+    
+    ShardLoad() : bytes(0), loadTime(0), opened(false), sorted(false) {}
+};
+
+struct ShardLoadReport {
+    vector<ShardLoad> shards;
+    bool merged;              // k-way merged (all shards sorted) vs concatenated
+    double loadTime;          // wall time for all shards
+    double mergeTime;
+    int rows;
+    int openedShards;
+};
+
+// External sort: phase timings and I/O volume of one run
+struct ExternalSortReport {
+    long long rows;
+    long long malformed;
+    int runs;                 // sorted runs spilled to temp files
+    int mergePasses;          // passes over the runs (0 if it fit in memory)
+    long long inputBytes;
+    long long spillBytesWritten;
+    long long spillBytesRead;
+    long long outputBytes;
+    double runPhaseTime;      // read, sort and spill, ms
+    double mergePhaseTime;
+    bool ok;
+    string error;
+};
+
+const int EXTERNAL_MERGE_FANIN = 64;        // runs merged per pass
+const size_t EXTERNAL_MIN_BUDGET = 1 << 20;
+
+// Approximate analytics. Each sketch has a fixed size chosen from the
+// error bounds in SketchSettings, whatever the number of orders streamed.
+struct SketchSettings {
+    double distinctError;     // HyperLogLog relative standard error
+    double countEpsilon;      // Count-Min: overestimate <= epsilon * total weight...
+    double countDelta;        // ...with probability 1 - delta
+    int topK;                 // heavy hitters kept per ranking
+    int reservoirSize;        // orders sampled for averages
+};
+
+SketchSettings sketchSettings = {0.01, 0.0005, 0.01, 10, 4096};
+
+struct HyperLogLog {
+    vector<uint8_t> registers;
+    int precision;            // 2^precision registers
+};
+
+const int HLL_MIN_PRECISION = 4;
+const int HLL_MAX_PRECISION = 18;     // 256 KB of registers per field
+
+struct CountMinSketch {
+    vector<long long> counts; // depth rows of width counters
+    size_t width;
+    int depth;
+    long long totalWeight;
+};
+
+// Min-heap on estimate of the k keys with the largest Count-Min estimates
+struct HeavyHitters {
+    vector<pair<long long, string> > heap;
+    size_t k;
+};
+
+struct OrderReservoir {
+    vector<Money> amounts;
+    vector<int> quantities;
+    size_t capacity;
+    long long seen;
+    mt19937_64 random;
+};
+
+struct OrderSketches {
+    HyperLogLog customers, products, phones;
+    CountMinSketch productQuantity, customerSpending;
+    HeavyHitters topProducts, topCustomers;
+    OrderReservoir sample;
+};
+
+// Streaming ingest: a tail thread parses lines appended to a file, FIFO
+// or stdin and queues them in batches; the menu thread applies each batch
+// to the store and its derived structures in place
+struct IngestBatch {
+    vector<Order*> orders;
+    vector<long long> sentMs;     // per order: trailing timestamp field, or -1
+    long long readMs;             // wall clock when the tail thread read the bytes
+};
+
+struct StreamIngest {
+    thread worker;
+    mutex lock;
+    vector<IngestBatch> ready;
+    atomic<bool> stop;
+    atomic<bool> finished;        // source ended or the tail thread stopped
+    atomic<long long> bytesRead;
+    atomic<long long> malformed;
+    
+    StreamIngest() : stop(false), finished(false), bytesRead(0), malformed(0) {}
+};
+
+const int INGEST_POLL_MS = 20;
+const int INGEST_REFRESH_MS = 500;
+
+// Ad-hoc queries such as
+//   category = Books AND quantity >= 10 GROUP BY productName SUM totalAmount
+// A query is compiled once into filters over the scan columns and run a
+// batch of QUERY_BATCH_SIZE rows at a time: each filter narrows a
+// selection vector of row positions and the aggregates read only the
+// selected rows. String columns are dictionary-encoded, so string filters
+// become a lookup on an integer code and groups are indexed by code.
+enum QueryColumn {
+    QUERY_ORDER_ID,
+    QUERY_CUSTOMER,
+    QUERY_PHONE,
+    QUERY_PRODUCT,
+    QUERY_CATEGORY,
+    QUERY_QUANTITY,
+    QUERY_UNIT_PRICE,
+    QUERY_TOTAL_AMOUNT,
+    QUERY_COLUMN_COUNT
+};
+
+const char* QUERY_COLUMN_NAMES[QUERY_COLUMN_COUNT] = {
+    "orderID", "customerName", "phoneNumber", "productName",
+    "category", "quantity", "unitPrice", "totalAmount"
+};
+
+// String columns are QUERY_CUSTOMER .. QUERY_CATEGORY
+const int QUERY_STRING_COLUMNS = 4;
+string Order::* const QUERY_STRING_FIELDS[QUERY_STRING_COLUMNS] = {
+    &Order::customerName, &Order::phoneNumber, &Order::productName, &Order::productCategory
+};
+
+// Batches line up with the compressed store's blocks, so a block's zone
+// map describes exactly one batch
+const int QUERY_BATCH_SIZE = COLUMN_BLOCK_SIZE;
+const int QUERY_DISPLAY_LIMIT = 20;
+
+struct DictionaryColumn {
+    vector<int> codes;                    // per row, in scan column order
+    vector<string> values;                // code -> text
+    vector<int> counts;                   // code -> rows with that text
+    unordered_map<string, int> lookup;    // text -> code
+    int builtVersion;
+    
+    DictionaryColumn() : builtVersion(-1) {}
+};
+
+DictionaryColumn queryDictionaries[QUERY_STRING_COLUMNS];
+
+enum FilterKind {
+    FILTER_RANGE,         // lo <= value <= hi
+    FILTER_NOT_EQUAL,     // value != lo
+    FILTER_CODES          // codeMatches[code]
+};
+
+struct CompiledFilter;
+
+// Filters rows into out. in == nullptr means the dense batch
+// [begin, begin + count); otherwise in holds count selected rows.
+typedef int (*FilterKernel)(const CompiledFilter& filter, const int* in, int count, int begin, int* out);
+
+struct CompiledFilter {
+    QueryColumn column;
+    FilterKind kind;
+    long long lo;
+    long long hi;
+    vector<char> codeMatches;     // one flag per dictionary code
+    const int* intData;           // orderID, quantity or dictionary codes
+    const Money* moneyData;       // unitPrice or totalAmount
+    FilterKernel kernel;
+    double estimate;              // expected fraction of rows kept
+    long long rowsIn;             // counted while the query runs
+    long long rowsOut;
+};
+
+enum AggregateKind { AGG_COUNT, AGG_SUM, AGG_AVG, AGG_MIN, AGG_MAX };
+
+struct QueryAggregate {
+    AggregateKind kind;
+    QueryColumn column;
+};
+
+struct CompiledQuery {
+    vector<CompiledFilter> filters;       // in evaluation order
+    vector<string> notes;                 // dictionary builds and rewrites, for the plan
+    bool neverMatches;                    // e.g. quantity > 5 AND quantity < 3
+    bool grouped;
+    QueryColumn groupBy;
+    vector<QueryAggregate> aggregates;
+    int limit;
+    double compileTime;
+};
+
+struct QueryGroup {
+    long long key;                        // dictionary code or column value
+    long long count;
+    vector<long long> values;             // one per aggregate; AVG holds the sum
+};
+
+struct QueryResult {
+    vector<QueryGroup> groups;
+    long long rowsScanned;
+    long long rowsMatched;
+    int batches;
+    int batchesSkipped;           // zone map ruled out every row
+    int filtersProven;            // (batch, filter) pairs the zone map proved
+    bool compressedScan;          // answered from the packed blocks
+    double executionTime;
+};
+
+struct SearchResult {
+    Order* order;
+    int position;
+};
+
+// Work-stealing task scheduler shared by reports, sorting and loading.
+// Each worker owns a deque: it pushes and pops its own tasks at the back
+// and idle workers steal from the front of other deques. Threads that are
+// not workers (the menu thread) push round-robin and help while waiting.
+struct TaskGroup {
+    atomic<int> pending;
+    mutex lock;                     // the last task signals finished under it
+    condition_variable finished;
+    
+    TaskGroup() : pending(0) {}
+};
+
+struct ScheduledTask {
+    function<void()> run;
+    TaskGroup* group;
+};
+
+struct WorkerQueue {
+    mutex lock;
+    deque<ScheduledTask> tasks;
+    atomic<long long> executed;
+    atomic<long long> steals;       // tasks this worker took from others
+    atomic<long long> busyNanos;
+    atomic<int> depth;
+    atomic<int> peakDepth;          // written under lock, read by the status screen
+    
+    WorkerQueue() : executed(0), steals(0), busyNanos(0), depth(0), peakDepth(0) {}
+};
+
+struct TaskScheduler {
+    vector<WorkerQueue*> queues;
+    vector<thread> workers;
+    mutex startLock;                // serialises start and stop
+    atomic<bool> running;           // set once queues and workers exist
+    mutex sleepLock;
+    condition_variable wake;
+    atomic<int> queuedTasks;
+    atomic<bool> stopping;
+    atomic<unsigned> nextQueue;
+    atomic<long long> submitted;
+    atomic<long long> helperExecuted;  // tasks run by non-workers while waiting
+    high_resolution_clock::time_point startTime;
+    
+    TaskScheduler() : running(false), queuedTasks(0), stopping(false), nextQueue(0), submitted(0), helperExecuted(0) {}
+};
+
+TaskScheduler taskScheduler;
+const int PARALLEL_GRAIN = 65536;   // rows per task for parallel scans
+const int PARALLEL_SORT_CUTOFF = 8192;
+
 // Function prototypes
 void mainMenu();
 void displayOrdersMenu();
@@ -42,77 +660,248 @@ void sortingMenu();
 void searchingMenu();
 void reportsMenu();
 void loadFromFile();
+void dataManagementMenu();
+vector<string> expandShardPatterns(const vector<string>& patterns);
+ShardLoadReport loadShards(const vector<string>& paths);
+vector<Order*> mergeSortedShards(const vector<ShardLoad>& shards);
+void printShardReport(const ShardLoadReport& report);
+void loadShardedFiles();
+ExternalSortReport externalSortFile(const string& inputPath, const string& outputPath, size_t memoryBudget);
+bool parseMemoryBudget(const string& text, size_t& bytes);
+void printExternalSortReport(const ExternalSortReport& report);
+void externalSortMenu();
+bool parseOrderLine(const string& line, Order* order);
 void saveToFile();
 void displayFirstNOrders(int n, bool sorted = false);
 void displayOrder(Order* order, int index);
+void displayOrderTableHeader();
+void browseOrdersByPage();
+void rendererReserve(TableRenderer& out, size_t bytes);
+void rendererText(TableRenderer& out, const char* text);
+void rendererPadded(TableRenderer& out, const string& text, int width);
+void rendererInt(TableRenderer& out, long long value, int width);
+void rendererMoney(TableRenderer& out, Money value, int width, bool thousands);
+void rendererFlush(TableRenderer& out);
+void renderOrderTableHeader(TableRenderer& out);
+void renderOrderRow(TableRenderer& out, Order* order, int index);
+int formatMoneyChars(Money value, bool thousands, char* out);
 SortStats insertionSort();
 SortStats quickSort();
 void quickSortRecursive(Order** arr, int low, int high, long long& swapCount);
 int partition(Order** arr, int low, int high, long long& swapCount);
-bool compareOrders(Order* a, Order* b);
+bool compareOrders(const Order* a, const Order* b);
+bool compareOrderKeys(const Order* a, const Order* b);
 void swapOrders(Order** a, Order** b);
 Order** convertToArray();
 void updateListFromArray(Order** arr);
+OrderSnapshot takeSnapshot();
+bool restoreSnapshot(const OrderSnapshot& snapshot);
+bool listIsSorted();
+void compareSortAlgorithms();
+void saveSnapshotScreen();
+void restoreSnapshotScreen();
 void linearSearch();
 void binarySearch();
 void optimizedLinearSearch();
 void performMultipleSearches();
+void rangeQuery();
+void simdLinearSearch();
+void bloomFilterMenu();
+void rebuildBloomFilter();
+void bloomInsert(int orderID, const string& customerName);
+void bloomAdd(int orderID, const string& customerName);
+bool bloomMayContain(int orderID, const string& customerName);
+void bloomRecordOutcome(bool found);
+void reportBloomReject(high_resolution_clock::time_point start);
+OrderColumns& getScanColumns();
+const ScanKernels& activeScanKernels();
+int availableScanKernels(const ScanKernels** tiers);
+SearchResult columnSearch(const ScanKernels& kernels, int searchOrderID, const string& searchName);
+SearchResult columnSearchIn(const OrderColumns& cols, const ScanKernels& kernels, int searchOrderID, const string& searchName);
+CategoryPartitions& getCategoryPartitions();
+int findCategoryPartition(const string& name);
+int promptCategoryPartition();
+void categorySearch();
+void categorySort();
+RangeIndex& getRangeIndex(RangeColumn column);
+void buildRangeIndex(RangeIndex& index, const vector<Order*>& rows, RangeColumn column);
+void findRangeBounds(const RangeIndex& index, long long minKey, long long maxKey, size_t& first, size_t& last);
+long long rangeColumnKey(Order* order, RangeColumn column);
+long long rangeInputKey(RangeColumn column, double value, bool isMax);
 void calculateTotalSales();
 void totalQuantitySold();
 void salesByCategory();
+void approximateAnalyticsMenu();
+void approximateAnalyticsReport(const string& path);
+bool readNextOrder(istream& input, string& line, Order& order, long long& malformed);
+void configureSketches();
+DictionaryColumn& getQueryDictionary(QueryColumn column);
+void appendToDictionary(DictionaryColumn& dict, const string& text);
+CompiledQuery compileQuery(const string& text);
+QueryResult runQuery(CompiledQuery& query);
+void printQueryPlan(const CompiledQuery& query, const QueryResult& result);
+void printQueryResult(const CompiledQuery& query, const QueryResult& result);
+bool executeQuery(const string& text);
+void queryEngineMenu();
+void initSketches(OrderSketches& sketches, const SketchSettings& settings);
+void sketchOrder(OrderSketches& sketches, const Order* order);
+size_t sketchMemoryBytes(const OrderSketches& sketches);
 void clearScreen();
-void pause();
+void pauseScreen();
 void freeMemory();
-void reloadData();
-string formatNumber(double num);
+string formatNumber(Money amount);
+string formatMoney(Money amount);
+Money parseMoney(const string& text);
+Money toCents(double amount);
+bool moneyInputInRange(double amount);
+void runServer(const string& endpoint);
+void runLoadGenerator(const string& endpoint, int clients, int requestsPerClient, int writePercent);
+bool loadOrdersFromFile(const string& path);
+vector<Order*> parseOrderBlock(const string& content);
+void appendOrders(const vector<Order*>& orders);
+void applyOrderBatch(const vector<Order*>& batch);
+void mergeIntoRangeIndex(RangeIndex& index, const vector<Order*>& batch, RangeColumn column);
+void appendToCategoryPartitions(const vector<Order*>& batch);
+void streamIngestMenu();
+void runStreamIngest(const string& source, bool fromStart, double seconds);
+void runFeedGenerator(const string& path, int rowsPerSecond, double seconds);
+long long wallClockMs();
+void startBackgroundLoad(const string& path);
+void stopBackgroundLoad();
+void adoptLoadedOrders();
+bool backgroundLoadActive();
+void waitForRows(int needed);
+void waitForBackgroundLoad();
+void printPartialDataNote();
+void printLoadProgress();
+SortStats parallelQuickSort();
+void startTaskScheduler();
+void stopTaskScheduler();
+void taskSchedulerStatus();
+void statsMenu();
+void compressedStorageReport();
+CompressedOrderStore& getCompressedStore();
+CompressedScanResult scanCompressedRange(const PackedColumn& filter, long long lo, long long hi,
+                                         const PackedColumn& sumColumn);
+long long sumCompressedColumn(const PackedColumn& column);
+void countStat(StatCounter counter, long long amount = 1);
+void recordTimer(StatTimer timer, long long nanos);
+
+void spawnTask(TaskGroup& group, const function<void()>& run);
+void waitTaskGroup(TaskGroup& group);
+void parallelFor(int begin, int end, int grain, const function<void(int, int)>& body);
+
+// Splits [begin, end) into grain-sized chunks, maps each chunk to a
+// partial result in parallel, then folds the partials in chunk order
+template <typename T>
+T parallelReduce(int begin, int end, int grain, const T& identity,
+                 const function<T(int, int)>& map, const function<T(const T&, const T&)>& combine) {
+    int chunks = (end - begin + grain - 1) / grain;
+    if(chunks <= 1) {
+        return (end > begin) ? map(begin, end) : identity;
+    }
+    vector<T> partials(chunks, identity);
+    parallelFor(0, chunks, 1, [&](int first, int last) {
+        for(int c = first; c < last; c++) {
+            partials[c] = map(begin + c * grain, min(end, begin + (c + 1) * grain));
+        }
+    });
+    T result = identity;
+    for(int c = 0; c < chunks; c++) {
+        result = combine(result, partials[c]);
+    }
+    return result;
+}
 
-int main() {
+int main(int argc, char* argv[]) {
+    programStart = high_resolution_clock::now();
     
-    // Auto-load data from file silently
-    ifstream checkFile("orders_data.txt");
-    if(checkFile.good()) {
-        checkFile.close();
-        
-        string line;
-        ifstream file("orders_data.txt");
-        Order* tail = nullptr;
-        while(getline(file, line)) {
-            Order* newOrder = new Order();
-            stringstream ss(line);
-            string temp;
-            
-            getline(ss, temp, '|'); newOrder->orderID = stoi(temp);
-            getline(ss, newOrder->customerName, '|');
-            getline(ss, newOrder->phoneNumber, '|');
-            getline(ss, newOrder->productName, '|');
-            getline(ss, newOrder->productCategory, '|');
-            getline(ss, temp, '|'); newOrder->quantity = stoi(temp);
-            getline(ss, temp, '|'); newOrder->unitPrice = stod(temp);
-            getline(ss, temp, '|'); newOrder->totalAmount = stod(temp);
-            
-            newOrder->next = nullptr;
-            if (orderList == nullptr) {
-                orderList = newOrder;
-                tail = newOrder;
-            } else {
-                tail->next = newOrder;
-                tail = newOrder;
-            }
-            orderCount++;
+    // Non-interactive modes:
+    //   --server [port|socket-path]
+    //   --loadgen [port|socket-path] [clients] [requests-per-client] [write-percent]
+    // The menu loads data in the background unless --sync-load is given.
+    string mode = (argc > 1) ? argv[1] : "";
+#ifdef _WIN32
+    if(mode == "--ingest") {
+        // Unsynced cin buffers ahead, which lets the stdin tail batch lines
+        ios::sync_with_stdio(false);
+    }
+#endif
+    //   --external-sort <input> <output> [budget-mb]  sorts a file on disk
+    //                                                 without loading it
+    if(mode == "--external-sort") {
+        if(argc < 4) {
+            cout << "Usage: OSOMS --external-sort <input> <output> [memory-budget-mb]\n";
+            return 1;
+        }
+        if(string(argv[2]) == argv[3]) {
+            cout << "Output must be a different file from the input\n";
+            return 1;
+        }
+        size_t budget = (size_t)64 << 20;
+        if(argc > 4 && !parseMemoryBudget(argv[4], budget)) {
+            cout << "Memory budget must be a number of MB, at least " << (EXTERNAL_MIN_BUDGET >> 20) << "\n";
+            return 1;
         }
-        file.close();
+        ExternalSortReport report = externalSortFile(argv[2], argv[3], budget);
+        printExternalSortReport(report);
+        stopTaskScheduler();
+        return report.ok ? 0 : 1;
     }
     
-    mainMenu();
+    //   --shards <file|glob>...  loads the shards instead, then shows the menu
+    if(mode.empty()) {
+        startBackgroundLoad("orders_data.txt");
+    } else if(mode == "--shards") {
+        printShardReport(loadShards(expandShardPatterns(vector<string>(argv + 2, argv + argc))));
+    } else {
+        loadOrdersFromFile("orders_data.txt");
+    }
+    
+    //   --ingest [file|fifo|-] [seconds]  tails a feed (0 s = until it closes
+    //                                      or, for a regular file, reads it once)
+    //   --feed <file> [rows-per-second] [seconds]  appends generated orders
+    //   --query "<query>"...  runs each query and prints its plan and result
+    int exitCode = 0;
+    if(mode == "--query") {
+        if(argc < 3) {
+            cout << "Usage: OSOMS --query \"category = Books AND quantity >= 10 GROUP BY productName SUM totalAmount\"...\n";
+            exitCode = 1;
+        }
+        for(int q = 2; q < argc; q++) {
+            cout << "\n  Query: " << argv[q] << "\n";
+            if(!executeQuery(argv[q])) {
+                exitCode = 1;
+            }
+        }
+    } else if(mode == "--ingest") {
+        runStreamIngest(argc > 2 ? argv[2] : "-", false, argc > 3 ? atof(argv[3]) : 0);
+    } else if(mode == "--feed") {
+        runFeedGenerator(argc > 2 ? argv[2] : "orders_data.txt",
+                         argc > 3 ? atoi(argv[3]) : 1000,
+                         argc > 4 ? atof(argv[4]) : 10);
+    } else if(mode == "--server") {
+        runServer(argc > 2 ? argv[2] : "/tmp/osoms.sock");
+    } else if(mode == "--loadgen") {
+        runLoadGenerator(argc > 2 ? argv[2] : "/tmp/osoms.sock",
+                         argc > 3 ? atoi(argv[3]) : 8,
+                         argc > 4 ? atoi(argv[4]) : 10000,
+                         argc > 5 ? atoi(argv[5]) : 1);
+    } else {
+        mainMenu();
+    }
     
+    stopBackgroundLoad();
+    stopTaskScheduler();
     freeMemory();
-    return 0;
+    return exitCode;
 }
 
 void mainMenu() {
     int choice;
     
     do {
+        adoptLoadedOrders();
         clearScreen();
         cout << "\n============================================================\n";
         cout << "                        MAIN MENUa                          \n";
@@ -121,9 +910,26 @@ void mainMenu() {
         cout << "  [2] Sorting\n";
         cout << "  [3] Searching\n";
         cout << "  [4] Reports\n";
+        cout << "  [5] Stats\n";
+        cout << "  [6] Data Management\n";
+        if(backgroundLoad.active) {
+            cout << "  [9] Refresh Load Progress\n";
+        }
         cout << "  [0] Exit\n";
         cout << "------------------------------------------------------------\n";
         cout << "  Total Orders in System: " << orderCount << "\n";
+        if(timeToFirstMenu < 0) {
+            long long nanos = duration_cast<nanoseconds>(high_resolution_clock::now() - programStart).count();
+            timeToFirstMenu = nanos / 1000000.0;
+            recordTimer(TIMER_FIRST_MENU, nanos);
+        }
+        if(backgroundLoad.active) {
+            printLoadProgress();
+            cout << "\n";
+        } else if(backgroundLoad.elapsedMs > 0) {
+            cout << "  Loaded in Background: " << fixed << setprecision(2) << backgroundLoad.elapsedMs << " ms\n";
+        }
+        cout << "  Time to First Menu: " << fixed << setprecision(2) << timeToFirstMenu << " ms\n";
         cout << "============================================================\n";
         cout << "  Enter choice: ";
         cin >> choice;
@@ -133,8 +939,11 @@ void mainMenu() {
             case 2: sortingMenu(); break;
             case 3: searchingMenu(); break;
             case 4: reportsMenu(); break;
+            case 5: statsMenu(); break;
+            case 6: dataManagementMenu(); break;
+            case 9: break;
             case 0: cout << "\n  Thank you for using OSOMS!\n\n"; break;
-            default: cout << "\n  Invalid choice!\n"; pause();
+            default: cout << "\n  Invalid choice!\n"; pauseScreen();
         }
     } while(choice != 0);
 }
@@ -142,10 +951,11 @@ void mainMenu() {
 
 
 void displayOrdersMenu() {
+    waitForRows(1);
     if(orderCount == 0) {
         clearScreen();
         cout << "\n  No data available! Please generate or load data first.\n";
-        pause();
+        pauseScreen();
         return;
     }
     
@@ -156,6 +966,7 @@ void displayOrdersMenu() {
     cout << "============================================================\n";
     cout << "  [1] Display First 100 Unsorted Orders\n";
     cout << "  [2] Display First 100 Sorted Orders\n";
+    cout << "  [3] Browse Orders by Page\n";
     cout << "  [0] Back to Main Menu\n";
     cout << "============================================================\n";
     cout << "  Enter choice: ";
@@ -164,16 +975,18 @@ void displayOrdersMenu() {
     switch(choice) {
         case 1: displayFirstNOrders(DISPLAY_LIMIT, false); break;
         case 2: displayFirstNOrders(DISPLAY_LIMIT, true); break;
+        case 3: browseOrdersByPage(); break;
         case 0: break;
-        default: cout << "\n  Invalid choice!\n"; pause();
+        default: cout << "\n  Invalid choice!\n"; pauseScreen();
     }
 }
 
 void sortingMenu() {
+    waitForBackgroundLoad();
     if(orderCount == 0) {
         clearScreen();
         cout << "\n  No data available! Please generate or load data first.\n";
-        pause();
+        pauseScreen();
         return;
     }
     
@@ -185,7 +998,9 @@ void sortingMenu() {
         cout << "============================================================\n";
         cout << "  [1] Insertion Sort\n";
         cout << "  [2] Quick Sort\n";
-        cout << "  [3] Compare Both Algorithms\n";
+        cout << "  [3] Compare All Algorithms\n";
+        cout << "  [4] Parallel Quick Sort\n";
+        cout << "  [5] Sort Within Category\n";
         cout << "  [0] Back to Main Menu\n";
         cout << "============================================================\n";
         cout << "  Enter choice: ";
@@ -222,53 +1037,37 @@ void sortingMenu() {
                 displayFirstNOrders(DISPLAY_LIMIT, true);
                 break;
                 
-            case 3: {
+            case 4:
                 clearScreen();
-                cout << "\n  Comparing Sorting Algorithms...\n\n";
-                cout << "  Running Insertion Sort on unsorted data...\n";
-                SortStats insertionStats = insertionSort();
-                
-                cout << "  Reloading data for fair comparison...\n";
-                reloadData();
-                
-                cout << "  Running Quick Sort on unsorted data...\n";
-                SortStats quickStats = quickSort();
+                cout << "\n  Performing Parallel Quick Sort...\n";
+                stats = parallelQuickSort();
+                cout << "\n  ========================================================\n";
+                cout << "            PARALLEL QUICK SORT RESULTS                  \n";
+                cout << "  ========================================================\n";
+                cout << "    Execution Time: " << fixed << setprecision(2) << stats.executionTime << " ms\n";
+                cout << "    Number of Swaps: " << stats.swapCount << "\n";
+                cout << "    Worker Threads: " << taskScheduler.queues.size() << "\n";
+                cout << "    Worst Case Complexity: O(n^2)\n";
+                cout << "  ========================================================\n";
+                displayFirstNOrders(DISPLAY_LIMIT, true);
+                break;
                 
-                cout << "\n  ==============================================================\n";
-                cout << "                SORTING ALGORITHMS COMPARISON                   \n";
-                cout << "  ==============================================================\n";
-                cout << "  +------------------+-----------------+-------------------------+\n";
-                cout << "  | Algorithm        | Time (ms)       | Swaps                   |\n";
-                cout << "  +------------------+-----------------+-------------------------+\n";
-                cout << "  | Insertion Sort   | " << setw(15) << fixed << setprecision(2) << insertionStats.executionTime 
-                     << " | " << setw(23) << insertionStats.swapCount << " |\n";
-                cout << "  | Quick Sort       | " << setw(15) << fixed << setprecision(2) << quickStats.executionTime 
-                     << " | " << setw(23) << quickStats.swapCount << " |\n";
-                cout << "  +------------------+-----------------+-------------------------+\n";
+            case 5: categorySort(); break;
                 
-                if(quickStats.executionTime < insertionStats.executionTime) {
-                    double improvement = ((insertionStats.executionTime - quickStats.executionTime) / insertionStats.executionTime) * 100;
-                    cout << "\n  Quick Sort is faster by " << fixed << setprecision(2) << improvement << "%\n";
-                } else {
-                    double improvement = ((quickStats.executionTime - insertionStats.executionTime) / quickStats.executionTime) * 100;
-                    cout << "\n  Insertion Sort is faster by " << fixed << setprecision(2) << improvement << "%\n";
-                }
-                cout << "  ==============================================================\n";
-                pause();
-                break;
-            }
+            case 3: compareSortAlgorithms(); break;
                 
             case 0: break;
-            default: cout << "\n  Invalid choice!\n"; pause();
+            default: cout << "\n  Invalid choice!\n"; pauseScreen();
         }
     } while(choice != 0);
 }
 
 void searchingMenu() {
+    waitForBackgroundLoad();
     if(orderCount == 0) {
         clearScreen();
         cout << "\n  No data available! Please generate or load data first.\n";
-        pause();
+        pauseScreen();
         return;
     }
     
@@ -281,6 +1080,11 @@ void searchingMenu() {
         cout << "  [1] Linear Search\n";
         cout << "  [2] Binary Search\n";
         cout << "  [3] Optimized Linear Search (Sentinel)\n";
+        cout << "  [4] Range Query (Indexed)\n";
+        cout << "  [5] SIMD Linear Search\n";
+        cout << "  [6] Search Benchmark (100 Searches)\n";
+        cout << "  [7] Bloom Filter Settings & Stats\n";
+        cout << "  [8] Search Within Category\n";
         cout << "  [0] Back to Main Menu\n";
         cout << "============================================================\n";
         cout << "  Enter choice: ";
@@ -290,18 +1094,24 @@ void searchingMenu() {
             case 1: linearSearch(); break;
             case 2: binarySearch(); break;
             case 3: optimizedLinearSearch(); break;
+            case 4: rangeQuery(); break;
+            case 5: simdLinearSearch(); break;
+            case 6: performMultipleSearches(); break;
+            case 7: bloomFilterMenu(); break;
+            case 8: categorySearch(); break;
             case 0: break;
-            default: cout << "\n  Invalid choice!\n"; pause();
+            default: cout << "\n  Invalid choice!\n"; pauseScreen();
         }
     } while(choice != 0);
 }
 
 
 void reportsMenu() {
+    waitForRows(1);
     if(orderCount == 0) {
         clearScreen();
         cout << "\n  No data available! Please generate or load data first.\n";
-        pause();
+        pauseScreen();
         return;
     }
     
@@ -314,6 +1124,9 @@ void reportsMenu() {
         cout << "  [1] Calculate Total Sales (Per Order)\n";
         cout << "  [2] Total Quantity Sold (By Product)\n";
         cout << "  [3] Sales Analysis (By Category)\n";
+        cout << "  [4] Compressed Column Storage\n";
+        cout << "  [5] Approximate Analytics (Sketches)\n";
+        cout << "  [6] Query Engine (Filter / Group / Aggregate)\n";
         cout << "  [0] Back to Main Menu\n";
         cout << "============================================================\n";
         cout << "  Enter choice: ";
@@ -323,25 +1136,60 @@ void reportsMenu() {
             case 1: calculateTotalSales(); break;
             case 2: totalQuantitySold(); break;
             case 3: salesByCategory(); break;
+            case 4: compressedStorageReport(); break;
+            case 5: approximateAnalyticsMenu(); break;
+            case 6: queryEngineMenu(); break;
             case 0: break;
-            default: cout << "\n  Invalid choice!\n"; pause();
+            default: cout << "\n  Invalid choice!\n"; pauseScreen();
         }
     } while(choice != 0);
 }
 
-
+void dataManagementMenu() {
+    int choice;
+    do {
+        clearScreen();
+        cout << "\n============================================================\n";
+        cout << "                  DATA MANAGEMENT MENU                     \n";
+        cout << "============================================================\n";
+        cout << "  [1] Reload orders_data.txt\n";
+        cout << "  [2] Save to orders_data.txt\n";
+        cout << "  [3] Load Sharded Files\n";
+        cout << "  [4] External Sort (File Larger Than Memory)\n";
+        cout << "  [5] Streaming Ingest (Tail a File)\n";
+        cout << "  [6] Save Snapshot of Current Order\n";
+        cout << "  [7] Restore Snapshot\n";
+        cout << "  [0] Back to Main Menu\n";
+        cout << "============================================================\n";
+        cout << "  Enter choice: ";
+        cin >> choice;
+        
+        switch(choice) {
+            case 1: loadFromFile(); break;
+            case 2: saveToFile(); break;
+            case 3: loadShardedFiles(); break;
+            case 4: externalSortMenu(); break;
+            case 5: streamIngestMenu(); break;
+            case 6: saveSnapshotScreen(); break;
+            case 7: restoreSnapshotScreen(); break;
+            case 0: break;
+            default: cout << "\n  Invalid choice!\n"; pauseScreen();
+        }
+    } while(choice != 0);
+}
 
 void saveToFile() {
+    waitForBackgroundLoad();
     if(orderCount == 0) {
         cout << "\n  No data to save!\n";
-        pause();
+        pauseScreen();
         return;
     }
     
     ofstream file("orders_data.txt");
     if(!file) {
         cout << "\n  Error creating file!\n";
-        pause();
+        pauseScreen();
         return;
     }
     
@@ -353,620 +1201,5951 @@ void saveToFile() {
              << current->productName << "|"
              << current->productCategory << "|"
              << current->quantity << "|"
-             << current->unitPrice << "|"
-             << current->totalAmount << "\n";
+             << formatMoney(current->unitPrice) << "|"
+             << formatMoney(current->totalAmount) << "\n";
         current = current->next;
     }
     
     file.close();
     cout << "\n  Data saved successfully to orders_data.txt!\n";
-    pause();
+    pauseScreen();
+}
+
+// Parses one "id|name|phone|product|category|qty|price|total" line.
+// Returns false (leaving order partly filled) if the line is malformed.
+bool parseOrderLine(const string& line, Order* order) {
+    stringstream ss(line);
+    string temp;
+    
+    try {
+        getline(ss, temp, '|'); order->orderID = stoi(temp);
+        getline(ss, order->customerName, '|');
+        getline(ss, order->phoneNumber, '|');
+        getline(ss, order->productName, '|');
+        getline(ss, order->productCategory, '|');
+        getline(ss, temp, '|'); order->quantity = stoi(temp);
+        getline(ss, temp, '|'); order->unitPrice = parseMoney(temp);
+        getline(ss, temp, '|'); order->totalAmount = parseMoney(temp);
+    } catch(const exception&) {
+        return false;
+    }
+    countStat(STAT_ROWS_PARSED);
+    return true;
 }
 
 void loadFromFile() {
     ifstream file("orders_data.txt");
     if(!file) {
         cout << "\n  Error: File not found!\n";
-        pause();
+        pauseScreen();
         return;
     }
+    file.close();
     
+    stopBackgroundLoad();
     freeMemory();
-    orderCount = 0;
-    
-    string line;
-    Order* tail = nullptr;
-    while(getline(file, line)) {
-        Order* newOrder = new Order();
-        stringstream ss(line);
-        string temp;
-        
-        getline(ss, temp, '|'); newOrder->orderID = stoi(temp);
-        getline(ss, newOrder->customerName, '|');
-        getline(ss, newOrder->phoneNumber, '|');
-        getline(ss, newOrder->productName, '|');
-        getline(ss, newOrder->productCategory, '|');
-        getline(ss, temp, '|'); newOrder->quantity = stoi(temp);
-        getline(ss, temp, '|'); newOrder->unitPrice = stod(temp);
-        getline(ss, temp, '|'); newOrder->totalAmount = stod(temp);
-        
-        newOrder->next = nullptr;
-        if (orderList == nullptr) {
-            orderList = newOrder;
-            tail = newOrder;
-        } else {
-            tail->next = newOrder;
-            tail = newOrder;
-        }
-        orderCount++;
-    }
-    
-    file.close();
+    loadOrdersFromFile("orders_data.txt");
     cout << "\n  Successfully loaded " << orderCount << " orders from file!\n";
-    pause();
+    pauseScreen();
 }
 
-void displayFirstNOrders(int n, bool sorted) {
-    clearScreen();
-    
-    auto startTime = high_resolution_clock::now();
-    
-    if(sorted) {
-        cout << "\n  Sorting data first...\n";
-        quickSort();
+// Reads the whole file, parses its lines in parallel on the task
+// scheduler and links the orders in file order. Returns false if the
+// file cannot be opened.
+bool loadOrdersFromFile(const string& path) {
+    ifstream file(path.c_str(), ios::binary);
+    if(!file) {
+        return false;
     }
+    ScopedTimer timer(TIMER_LOAD);
+    stringstream buffer;
+    buffer << file.rdbuf();
+    file.close();
     
-    cout << "\n" << (sorted ? "SORTED" : "UNSORTED") << " ORDERS (First " << min(n, orderCount) << ")\n";
-    cout << "========================================================================================================================\n";
-    
-    cout << " No  OrderID  Customer Name        Phone Number   Product Name         Category          Qty    UnitPrice  TotalAmt\n";
-    cout << "========================================================================================================================\n";
-    
-    Order* current = orderList;
-    int count = 0;
-    
-    while(current != nullptr && count < n) {
-        displayOrder(current, count + 1);
-        current = current->next;
-        count++;
+    appendOrders(parseOrderBlock(buffer.str()));
+    rebuildBloomFilter();
+    return true;
+}
+
+// Parses every line of content in parallel on the task scheduler and
+// returns the orders in file order (malformed and blank lines dropped)
+vector<Order*> parseOrderBlock(const string& content) {
+    vector<size_t> lineStarts;
+    size_t pos = 0;
+    while(pos < content.size()) {
+        lineStarts.push_back(pos);
+        size_t newline = content.find('\n', pos);
+        pos = (newline == string::npos) ? content.size() : newline + 1;
     }
+    lineStarts.push_back(content.size());
     
-    auto endTime = high_resolution_clock::now();
-    double executionTime = duration_cast<microseconds>(endTime - startTime).count() / 1000.0;
+    int lineCount = (int)lineStarts.size() - 1;
+    vector<Order*> parsed(lineCount, nullptr);
+    parallelFor(0, lineCount, PARALLEL_GRAIN / 16, [&](int first, int last) {
+        for(int i = first; i < last; i++) {
+            size_t start = lineStarts[i];
+            size_t length = lineStarts[i + 1] - start;
+            while(length > 0 && (content[start + length - 1] == '\n' || content[start + length - 1] == '\r')) {
+                length--;
+            }
+            if(length == 0) {
+                continue;
+            }
+            Order* newOrder = new Order();
+            if(parseOrderLine(content.substr(start, length), newOrder)) {
+                parsed[i] = newOrder;
+            } else {
+                delete newOrder;
+            }
+        }
+    });
+    countStat(STAT_ALLOCATIONS, lineCount);
     
-    cout << "========================================================================================================================\n";
-    cout << "\n  Total orders displayed: " << count << " / " << orderCount << "\n";
-    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
-    pause();
+    vector<Order*> orders;
+    orders.reserve(lineCount);
+    for(int i = 0; i < lineCount; i++) {
+        if(parsed[i] != nullptr) {
+            orders.push_back(parsed[i]);
+        }
+    }
+    return orders;
 }
 
-void displayOrder(Order* order, int index) {
-    cout << setw(3) << right << index << "    "
-         << setw(5) << right << order->orderID << "   "
-         << setw(20) << left << order->customerName.substr(0, 20) << " "
-         << setw(14) << left << order->phoneNumber.substr(0, 14) << " "
-         << setw(20) << left << order->productName.substr(0, 20) << " "
-         << setw(15) << left << order->productCategory.substr(0, 15) << " "
-         << setw(4) << right << order->quantity << " "
-         << setw(10) << right << fixed << setprecision(2) << order->unitPrice << " "
-         << setw(11) << right << fixed << setprecision(2) << order->totalAmount
-         << "\n";
+// Links orders onto the end of the list. Callers refresh the Bloom filter.
+void appendOrders(const vector<Order*>& orders) {
+    if(orders.empty()) {
+        return;
+    }
+    for(size_t i = 0; i < orders.size(); i++) {
+        orders[i]->next = nullptr;
+        if(orderTail == nullptr) {
+            orderList = orders[i];
+        } else {
+            orderTail->next = orders[i];
+        }
+        orderTail = orders[i];
+    }
+    orderCount += (int)orders.size();
+    dataVersion++;
+    layoutVersion++;
 }
 
-SortStats insertionSort() {
-    SortStats stats;
-    stats.swapCount = 0;
+// ---------------------------------------------------------------------
+// Sharded loading
+// ---------------------------------------------------------------------
+
+// Expands glob patterns (POSIX only; elsewhere names are taken as given).
+// A pattern that matches nothing is kept so the report shows it missing.
+vector<string> expandShardPatterns(const vector<string>& patterns) {
+    vector<string> paths;
+    for(size_t p = 0; p < patterns.size(); p++) {
+#ifndef _WIN32
+        glob_t matches;
+        if(glob(patterns[p].c_str(), 0, nullptr, &matches) == 0) {
+            for(size_t i = 0; i < matches.gl_pathc; i++) {
+                paths.push_back(matches.gl_pathv[i]);
+            }
+            globfree(&matches);
+            continue;
+        }
+        globfree(&matches);
+#endif
+        paths.push_back(patterns[p]);
+    }
+    return paths;
+}
+
+// Reads and parses every shard as its own task, then replaces the current
+// data. If every shard is already sorted by compareOrders the shards are
+// k-way merged into one sorted list; otherwise they are linked in order.
+ShardLoadReport loadShards(const vector<string>& paths) {
+    ShardLoadReport report;
+    report.shards.resize(paths.size());
+    report.merged = false;
+    report.mergeTime = 0;
+    report.rows = 0;
     
-    Order** arr = convertToArray();
-    auto start = high_resolution_clock::now();
+    ScopedTimer loadTimer(TIMER_SHARD_LOAD);
+    TaskGroup group;
+    for(size_t s = 0; s < paths.size(); s++) {
+        ShardLoad* shard = &report.shards[s];
+        shard->path = paths[s];
+        spawnTask(group, [shard]() {
+            auto start = high_resolution_clock::now();
+            ifstream file(shard->path.c_str(), ios::binary);
+            if(!file) {
+                return;
+            }
+            stringstream buffer;
+            buffer << file.rdbuf();
+            string content = buffer.str();
+            shard->opened = true;
+            shard->bytes = (long long)content.size();
+            shard->orders = parseOrderBlock(content);
+            shard->sorted = is_sorted(shard->orders.begin(), shard->orders.end(), compareOrders);
+            shard->loadTime = duration_cast<microseconds>(high_resolution_clock::now() - start).count() / 1000.0;
+        });
+    }
+    waitTaskGroup(group);
+    report.loadTime = loadTimer.stop();
     
-    for(int i = 1; i < orderCount; i++) {
-        Order* key = arr[i];
-        int j = i - 1;
-        
-        while(j >= 0 && compareOrders(key, arr[j])) {
-            arr[j + 1] = arr[j];
-            stats.swapCount++;
-            j--;
+    bool allSorted = true;
+    report.openedShards = 0;
+    for(size_t s = 0; s < report.shards.size(); s++) {
+        if(report.shards[s].opened) {
+            report.rows += (int)report.shards[s].orders.size();
+            allSorted = allSorted && report.shards[s].sorted;
+            report.openedShards++;
         }
-        arr[j + 1] = key;
+    }
+    if(report.openedShards == 0) {
+        return report;    // nothing to load: keep the current data
     }
     
-    auto end = high_resolution_clock::now();
-    stats.executionTime = duration_cast<microseconds>(end - start).count() / 1000.0;
-    
-    updateListFromArray(arr);
-    delete[] arr;
-    
-    return stats;
+    stopBackgroundLoad();
+    freeMemory();
+    ScopedTimer mergeTimer(TIMER_SHARD_MERGE);
+    if(allSorted && report.openedShards > 1) {
+        appendOrders(mergeSortedShards(report.shards));
+        report.merged = true;
+    } else {
+        for(size_t s = 0; s < report.shards.size(); s++) {
+            appendOrders(report.shards[s].orders);
+        }
+    }
+    report.mergeTime = mergeTimer.stop();
+    rebuildBloomFilter();
+    return report;
 }
 
-SortStats quickSort() {
-    SortStats stats;
-    stats.swapCount = 0;
-    
-    Order** arr = convertToArray();
+// Heap entry for the k-way merge: the head of one shard
+struct ShardCursor {
+    Order* order;
+    size_t shard;
+    size_t next;              // index of the following order in that shard
+};
+
+struct ShardCursorAfter {
+    long long* comparisons;   // calls made by the heap, for STAT_COMPARISONS
     
-    auto start = high_resolution_clock::now();
-    quickSortRecursive(arr, 0, orderCount - 1, stats.swapCount);
-    auto end = high_resolution_clock::now();
+    // priority_queue keeps the "largest" on top, so invert compareOrders
+    bool operator()(const ShardCursor& a, const ShardCursor& b) const {
+        (*comparisons)++;
+        if(compareOrders(b.order, a.order)) return true;
+        if(compareOrders(a.order, b.order)) return false;
+        return a.shard > b.shard;     // ties keep shard order
+    }
+};
+
+// Merges shards that are each sorted by compareOrders in O(n log k)
+vector<Order*> mergeSortedShards(const vector<ShardLoad>& shards) {
+    long long comparisons = 0;
+    ShardCursorAfter after = {&comparisons};
+    priority_queue<ShardCursor, vector<ShardCursor>, ShardCursorAfter> heads(after);
+    size_t total = 0;
+    for(size_t s = 0; s < shards.size(); s++) {
+        total += shards[s].orders.size();
+        if(!shards[s].orders.empty()) {
+            ShardCursor cursor = {shards[s].orders[0], s, 1};
+            heads.push(cursor);
+        }
+    }
     
-    stats.executionTime = duration_cast<microseconds>(end - start).count() / 1000.0;
+    vector<Order*> merged;
+    merged.reserve(total);
+    while(!heads.empty()) {
+        ShardCursor cursor = heads.top();
+        heads.pop();
+        merged.push_back(cursor.order);
+        const vector<Order*>& source = shards[cursor.shard].orders;
+        if(cursor.next < source.size()) {
+            cursor.order = source[cursor.next++];
+            heads.push(cursor);
+        }
+    }
+    countStat(STAT_COMPARISONS, comparisons);
+    return merged;
+}
+
+void printShardReport(const ShardLoadReport& report) {
+    cout << "\n  +------------------------------+----------+--------------+-------------+--------+\n";
+    cout << "  | Shard                        | Orders   | Bytes        | Load (ms)   | Sorted |\n";
+    cout << "  +------------------------------+----------+--------------+-------------+--------+\n";
+    for(size_t s = 0; s < report.shards.size(); s++) {
+        const ShardLoad& shard = report.shards[s];
+        string name = shard.path.size() > 28 ? "..." + shard.path.substr(shard.path.size() - 25) : shard.path;
+        cout << "  | " << setw(28) << left << name << " | ";
+        if(!shard.opened) {
+            cout << setw(8) << "MISSING" << " | " << setw(12) << "" << " | " << setw(11) << "" << " | " << setw(6) << "" << " |\n";
+            continue;
+        }
+        cout << setw(8) << right << shard.orders.size()
+             << " | " << setw(12) << shard.bytes
+             << " | " << setw(11) << fixed << setprecision(2) << shard.loadTime
+             << " | " << setw(6) << left << (shard.sorted ? "Yes" : "No") << " |\n";
+    }
+    cout << "  +------------------------------+----------+--------------+-------------+--------+\n";
+    cout << "  Total Orders: " << report.rows << " from " << report.shards.size() << " shard(s)\n";
+    cout << "  Load Time (all shards): " << fixed << setprecision(4) << report.loadTime << " ms\n";
+    if(report.openedShards == 0) {
+        cout << "  No shard could be opened; the current data was kept.\n";
+        return;
+    }
+    if(report.merged) {
+        cout << "  Merge: k-way heap merge of " << report.openedShards << " sorted shards (list is sorted)\n";
+    } else {
+        cout << "  Merge: shards linked in order (not every shard is sorted)\n";
+    }
+    cout << "  Merge Time: " << fixed << setprecision(4) << report.mergeTime << " ms\n";
+}
+
+void loadShardedFiles() {
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "                  LOAD SHARDED FILES                       \n";
+    cout << "============================================================\n";
+    cout << "  Enter file names or glob patterns separated by spaces\n";
+    cout << "  (e.g. orders_2024_*.txt north.txt south.txt): ";
+    cin >> ws;
+    string line;
+    getline(cin, line);
     
-    updateListFromArray(arr);
-    delete[] arr;
+    vector<string> patterns;
+    stringstream words(line);
+    string word;
+    while(words >> word) {
+        patterns.push_back(word);
+    }
+    vector<string> paths = expandShardPatterns(patterns);
+    if(paths.empty()) {
+        cout << "\n  No files given!\n";
+        pauseScreen();
+        return;
+    }
     
-    return stats;
+    printShardReport(loadShards(paths));
+    pauseScreen();
 }
 
-void quickSortRecursive(Order** arr, int low, int high, long long& swapCount) {
-    if(low < high) {
-        int pi = partition(arr, low, high, swapCount);
-        quickSortRecursive(arr, low, pi - 1, swapCount);
-        quickSortRecursive(arr, pi + 1, high, swapCount);
+// ---------------------------------------------------------------------
+// External sort
+// ---------------------------------------------------------------------
+
+// Spilled runs hold orders in a compact binary form: the numeric fields
+// at fixed width, then the four strings as a 32-bit length plus bytes
+void writeRunRecord(ostream& out, const Order& order, long long& bytes) {
+    int32_t numbers[2] = {order.orderID, order.quantity};
+    int64_t money[2] = {order.unitPrice, order.totalAmount};
+    out.write((const char*)numbers, sizeof(numbers));
+    out.write((const char*)money, sizeof(money));
+    bytes += sizeof(numbers) + sizeof(money);
+    const string* fields[4] = {&order.customerName, &order.phoneNumber, &order.productName, &order.productCategory};
+    for(int f = 0; f < 4; f++) {
+        uint32_t length = (uint32_t)fields[f]->size();    // lines are far below 4 GiB
+        out.write((const char*)&length, sizeof(length));
+        out.write(fields[f]->data(), length);
+        bytes += sizeof(length) + length;
     }
 }
 
-int partition(Order** arr, int low, int high, long long& swapCount) {
-    Order* pivot = arr[high];
-    int i = low - 1;
-    
-    for(int j = low; j < high; j++) {
-        if(compareOrders(arr[j], pivot)) {
-            i++;
-            swapOrders(&arr[i], &arr[j]);
-            swapCount++;
+bool readRunRecord(istream& in, Order& order, long long& bytes) {
+    int32_t numbers[2];
+    int64_t money[2];
+    if(!in.read((char*)numbers, sizeof(numbers)) || !in.read((char*)money, sizeof(money))) {
+        return false;
+    }
+    order.orderID = numbers[0];
+    order.quantity = numbers[1];
+    order.unitPrice = money[0];
+    order.totalAmount = money[1];
+    bytes += sizeof(numbers) + sizeof(money);
+    string* fields[4] = {&order.customerName, &order.phoneNumber, &order.productName, &order.productCategory};
+    for(int f = 0; f < 4; f++) {
+        uint32_t length;
+        if(!in.read((char*)&length, sizeof(length))) {
+            return false;
         }
+        fields[f]->resize(length);
+        if(length > 0 && !in.read(&(*fields[f])[0], length)) {
+            return false;
+        }
+        bytes += sizeof(length) + length;
     }
-    swapOrders(&arr[i + 1], &arr[high]);
-    swapCount++;
-    return i + 1;
+    return true;
 }
 
-bool compareOrders(Order* a, Order* b) {
-    if(a->totalAmount != b->totalAmount) {
-        return a->totalAmount > b->totalAmount;
-    }
-    return a->orderID < b->orderID;
+// Same text layout as saveToFile
+void writeOrderText(ostream& out, const Order& order, long long& bytes) {
+    string line = to_string(order.orderID) + "|" + order.customerName + "|" + order.phoneNumber + "|"
+                + order.productName + "|" + order.productCategory + "|" + to_string(order.quantity) + "|"
+                + formatMoney(order.unitPrice) + "|" + formatMoney(order.totalAmount) + "\n";
+    out.write(line.data(), line.size());
+    bytes += (long long)line.size();
 }
 
-void swapOrders(Order** a, Order** b) {
-    Order* temp = *a;
-    *a = *b;
-    *b = temp;
+// Heap entry for merging runs: the current order of one run
+struct RunCursor {
+    Order order;
+    size_t run;
+};
+
+struct RunCursorAfter {
+    bool operator()(const RunCursor* a, const RunCursor* b) const {
+        if(compareOrders(&b->order, &a->order)) return true;
+        if(compareOrders(&a->order, &b->order)) return false;
+        return a->run > b->run;       // ties keep input order
+    }
+};
+
+bool compareOrderValues(const Order& a, const Order& b) {
+    return compareOrders(&a, &b);
 }
 
-Order** convertToArray() {
-    Order** arr = new Order*[orderCount];
-    Order* current = orderList;
-    int index = 0;
+// Merges runs[first, last) into out, as binary (another run) or as text.
+// Each input gets an equal share of the memory budget as its read buffer.
+bool mergeRuns(const vector<string>& runs, size_t first, size_t last, ostream& out, bool asText,
+               size_t memoryBudget, ExternalSortReport& report) {
+    size_t count = last - first;
+    size_t bufferSize = max((size_t)4096, memoryBudget / (count + 1));
+    vector<vector<char> > buffers(count, vector<char>(bufferSize));
+    vector<ifstream*> inputs(count);
+    vector<RunCursor> cursors(count);
+    priority_queue<RunCursor*, vector<RunCursor*>, RunCursorAfter> heads;
     
-    while(current != nullptr) {
-        arr[index++] = current;
-        current = current->next;
+    bool ok = true;
+    for(size_t i = 0; i < count; i++) {
+        inputs[i] = new ifstream();
+        inputs[i]->rdbuf()->pubsetbuf(&buffers[i][0], bufferSize);
+        inputs[i]->open(runs[first + i].c_str(), ios::binary);
+        cursors[i].run = i;
+        if(!*inputs[i]) {
+            ok = false;
+        } else if(readRunRecord(*inputs[i], cursors[i].order, report.spillBytesRead)) {
+            heads.push(&cursors[i]);
+        }
     }
     
-    return arr;
+    while(ok && !heads.empty()) {
+        RunCursor* cursor = heads.top();
+        heads.pop();
+        if(asText) {
+            writeOrderText(out, cursor->order, report.outputBytes);
+        } else {
+            writeRunRecord(out, cursor->order, report.spillBytesWritten);
+        }
+        if(readRunRecord(*inputs[cursor->run], cursor->order, report.spillBytesRead)) {
+            heads.push(cursor);
+        }
+    }
+    for(size_t i = 0; i < count; i++) {
+        delete inputs[i];
+    }
+    return ok && (bool)out;
 }
 
-void updateListFromArray(Order** arr) {
-    orderList = arr[0];
-    for(int i = 0; i < orderCount - 1; i++) {
-        arr[i]->next = arr[i + 1];
+// Parses a budget in MB (fractions allowed) into bytes; false unless the
+// whole text is a number giving at least EXTERNAL_MIN_BUDGET bytes
+bool parseMemoryBudget(const string& text, size_t& bytes) {
+    char* end = nullptr;
+    double megabytes = strtod(text.c_str(), &end);
+    if(text.empty() || *end != '\0' || !(megabytes > 0)) {
+        return false;
     }
-    arr[orderCount - 1]->next = nullptr;
+    double value = megabytes * 1024 * 1024;
+    if(value < (double)EXTERNAL_MIN_BUDGET || value >= (double)(SIZE_MAX / 2)) {
+        return false;
+    }
+    bytes = (size_t)value;
+    return true;
 }
 
-void linearSearch() {
-    clearScreen();
-    int searchOrderID;
-    string searchName;
-    
-    cout << "\n============================================================\n";
-    cout << "                     LINEAR SEARCH                         \n";
-    cout << "============================================================\n";
-    cout << "  Enter Order ID: ";
-    cin >> searchOrderID;
-    cin.ignore();
-    cout << "  Enter Customer Name: ";
-    getline(cin, searchName);
+// Sorts inputPath into outputPath by compareOrders using about memoryBudget
+// bytes: sorted runs are spilled to temp files next to the output, then
+// merged EXTERNAL_MERGE_FANIN at a time until one pass writes the output.
+ExternalSortReport externalSortFile(const string& inputPath, const string& outputPath, size_t memoryBudget) {
+    ExternalSortReport report = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, false, ""};
+    memoryBudget = max(memoryBudget, EXTERNAL_MIN_BUDGET);
+    ScopedTimer total(TIMER_EXTERNAL_SORT);
     
-    auto start = high_resolution_clock::now();
-    
-    Order* current = orderList;
-    bool found = false;
-    int position = 0;
+    ifstream input(inputPath.c_str(), ios::binary);
+    if(!input) {
+        report.error = "cannot open " + inputPath;
+        return report;
+    }
     
-    while(current != nullptr) {
-        position++;
-        if(current->orderID == searchOrderID && current->customerName == searchName) {
-            found = true;
+    // Phase 1: fill the budget with parsed orders, sort, spill
+    auto phaseStart = high_resolution_clock::now();
+    vector<string> runs;
+    vector<Order> batch;
+    size_t stringBytes = 0;
+    string line;
+    bool spillFailed = false;
+    while(true) {
+        bool more = (bool)getline(input, line);
+        if(more) {
+            report.inputBytes += (long long)line.size() + 1;
+            if(!line.empty() && line[line.size() - 1] == '\r') {
+                line.erase(line.size() - 1);
+            }
+            if(line.empty()) {
+                continue;
+            }
+            Order order;
+            if(!parseOrderLine(line, &order)) {
+                report.malformed++;
+                continue;
+            }
+            stringBytes += order.customerName.capacity() + order.phoneNumber.capacity()
+                         + order.productName.capacity() + order.productCategory.capacity();
+            batch.push_back(order);
+            report.rows++;
+        }
+        size_t used = batch.capacity() * sizeof(Order) + stringBytes;
+        bool full = used >= memoryBudget;
+        if(!full && more) {
+            continue;
+        }
+        if(!more && runs.empty()) {
+            break;    // everything fit: sort in memory and write the output directly
+        }
+        if(!batch.empty()) {
+            sort(batch.begin(), batch.end(), compareOrderValues);
+            string runPath = outputPath + ".run" + to_string(runs.size()) + ".tmp";
+            ofstream run(runPath.c_str(), ios::binary);
+            for(size_t i = 0; i < batch.size(); i++) {
+                writeRunRecord(run, batch[i], report.spillBytesWritten);
+            }
+            runs.push_back(runPath);
+            if(!run) {
+                spillFailed = true;
+                break;
+            }
+            vector<Order>().swap(batch);
+            stringBytes = 0;
+        }
+        if(!more) {
             break;
         }
-        current = current->next;
     }
+    input.close();
+    report.runs = (int)runs.size();
+    report.runPhaseTime = duration_cast<microseconds>(high_resolution_clock::now() - phaseStart).count() / 1000.0;
     
-    auto end = high_resolution_clock::now();
-    double executionTime = duration_cast<microseconds>(end - start).count() / 1000.0;
+    // Phase 2: merge runs until one pass can write the output
+    phaseStart = high_resolution_clock::now();
+    bool ok = !spillFailed;
+    if(ok && runs.empty()) {
+        sort(batch.begin(), batch.end(), compareOrderValues);
+        ofstream output(outputPath.c_str(), ios::binary);
+        for(size_t i = 0; i < batch.size(); i++) {
+            writeOrderText(output, batch[i], report.outputBytes);
+        }
+        ok = (bool)output;
+    }
+    int generation = 0;
+    while(ok && runs.size() > (size_t)EXTERNAL_MERGE_FANIN) {
+        vector<string> next;
+        for(size_t first = 0; first < runs.size() && ok; first += EXTERNAL_MERGE_FANIN) {
+            size_t last = min(runs.size(), first + EXTERNAL_MERGE_FANIN);
+            string mergedPath = outputPath + ".merge" + to_string(generation) + "_" + to_string(next.size()) + ".tmp";
+            ofstream merged(mergedPath.c_str(), ios::binary);
+            ok = mergeRuns(runs, first, last, merged, false, memoryBudget, report);
+            next.push_back(mergedPath);
+        }
+        for(size_t i = 0; i < runs.size(); i++) {
+            remove(runs[i].c_str());
+        }
+        runs.swap(next);
+        report.mergePasses++;
+        generation++;
+    }
+    if(ok && !runs.empty()) {
+        ofstream output(outputPath.c_str(), ios::binary);
+        ok = mergeRuns(runs, 0, runs.size(), output, true, memoryBudget, report);
+        report.mergePasses++;
+    }
+    for(size_t i = 0; i < runs.size(); i++) {
+        remove(runs[i].c_str());
+    }
+    report.mergePhaseTime = duration_cast<microseconds>(high_resolution_clock::now() - phaseStart).count() / 1000.0;
     
+    report.ok = ok;
+    if(!ok) {
+        report.error = "write to " + outputPath + " (or its temp runs) failed";
+    }
+    return report;
+}
+
+void printExternalSortReport(const ExternalSortReport& report) {
+    if(!report.ok) {
+        cout << "\n  Error: " << report.error << "\n";
+        return;
+    }
+    double totalTime = report.runPhaseTime + report.mergePhaseTime;
     cout << "\n  ============================================================\n";
-    if(found) {
-        cout << "  Status: FOUND\n";
-        cout << "  Position: " << position << "\n";
-        cout << "  ------------------------------------------------------------\n";
-        cout << "  Order ID: " << current->orderID << "\n";
-        cout << "  Customer: " << current->customerName << "\n";
-        cout << "  Phone: " << current->phoneNumber << "\n";
-        cout << "  Product: " << current->productName << "\n";
-        cout << "  Category: " << current->productCategory << "\n";
-        cout << "  Total Amount: RM " << fixed << setprecision(2) << current->totalAmount << "\n";
-    } else {
-        cout << "  Status: NOT FOUND\n";
+    cout << "  Orders Sorted: " << report.rows;
+    if(report.malformed > 0) {
+        cout << " (" << report.malformed << " malformed lines skipped)";
     }
-    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
-    cout << "  ============================================================\n";
-    pause();
+    cout << "\n";
+    cout << "  Runs Spilled: " << report.runs << "  |  Merge Passes: " << report.mergePasses << "\n";
+    cout << "  ------------------------------------------------------------\n";
+    cout << "  Input Read:          " << setw(14) << right << report.inputBytes << " bytes\n";
+    cout << "  Temp Runs Written:   " << setw(14) << report.spillBytesWritten << " bytes\n";
+    cout << "  Temp Runs Read:      " << setw(14) << report.spillBytesRead << " bytes\n";
+    cout << "  Output Written:      " << setw(14) << report.outputBytes << " bytes\n";
+    cout << "  ------------------------------------------------------------\n";
+    cout << "  Run Phase (read, sort, spill): " << fixed << setprecision(4) << report.runPhaseTime << " ms\n";
+    cout << "  Merge Phase:                   " << fixed << setprecision(4) << report.mergePhaseTime << " ms\n";
+    cout << "  Execution Time: " << fixed << setprecision(4) << totalTime << " ms";
+    if(totalTime > 0) {
+        cout << " (" << fixed << setprecision(1) << report.rows / totalTime / 1000.0 << " M rows/s)";
+    }
+    cout << "\n  ============================================================\n";
 }
 
-void binarySearch() {
+void externalSortMenu() {
     clearScreen();
-    int searchOrderID;
-    string searchName;
-    
     cout << "\n============================================================\n";
-    cout << "                     BINARY SEARCH                         \n";
+    cout << "                    EXTERNAL SORT                          \n";
     cout << "============================================================\n";
-    cout << "  Note: Data will be sorted first for binary search.\n\n";
-    cout << "  Enter Order ID: ";
-    cin >> searchOrderID;
-    cin.ignore();
-    cout << "  Enter Customer Name: ";
-    getline(cin, searchName);
+    cout << "  Sorts a file by Total Amount (DESC), Order ID (ASC) without\n";
+    cout << "  loading it; the orders in memory are not changed.\n\n";
     
-    quickSort();
-    Order** arr = convertToArray();
-    
-    auto start = high_resolution_clock::now();
+    string inputPath, outputPath, budgetText;
+    size_t budget;
+    cout << "  Input file: ";
+    cin >> inputPath;
+    cout << "  Output file: ";
+    cin >> outputPath;
+    cout << "  Memory budget (MB, at least " << (EXTERNAL_MIN_BUDGET >> 20) << "): ";
+    cin >> budgetText;
+    if(!cin || !parseMemoryBudget(budgetText, budget)) {
+        cin.clear();
+        cout << "\n  Invalid memory budget!\n";
+        pauseScreen();
+        return;
+    }
+    if(inputPath == outputPath) {
+        cout << "\n  Output must be a different file from the input!\n";
+        pauseScreen();
+        return;
+    }
     
-    int left = 0, right = orderCount - 1;
-    bool found = false;
-    int position = -1;
+    cout << "\n  Sorting " << inputPath << "...\n";
+    printExternalSortReport(externalSortFile(inputPath, outputPath, budget));
+    pauseScreen();
+}
+
+// Appends a batch to the list and updates the derived structures that were
+// current before it (scan columns, category partitions, query dictionaries,
+// range indexes, Bloom filter) in place instead of leaving them to a full
+// rebuild. Everything here costs O(batch); the range indexes only queue
+// the rows, and getRangeIndex merges them in O(n + k log k) when next read.
+void applyOrderBatch(const vector<Order*>& batch) {
+    if(batch.empty()) {
+        return;
+    }
+    int previousData = dataVersion;
+    int previousLayout = layoutVersion;
+    appendOrders(batch);
     
-    while(left <= right) {
-        int mid = left + (right - left) / 2;
-        
-        if(arr[mid]->orderID == searchOrderID && arr[mid]->customerName == searchName) {
-            found = true;
-            position = mid + 1;
-            break;
+    OrderColumns& cols = scanColumns;
+    if(cols.builtVersion == previousLayout) {
+        for(size_t i = 0; i < batch.size(); i++) {
+            cols.rows.push_back(batch[i]);
+            cols.orderID.push_back(batch[i]->orderID);
+            cols.quantity.push_back(batch[i]->quantity);
+            cols.unitPrice.push_back(batch[i]->unitPrice);
+            cols.totalAmount.push_back(batch[i]->totalAmount);
         }
-        
-        if(arr[mid]->orderID < searchOrderID) {
-            left = mid + 1;
-        } else {
-            right = mid - 1;
+        cols.builtVersion = layoutVersion;
+    }
+    if(categoryPartitions.builtVersion == previousLayout) {
+        appendToCategoryPartitions(batch);
+    }
+    for(int d = 0; d < QUERY_STRING_COLUMNS; d++) {
+        DictionaryColumn& dict = queryDictionaries[d];
+        if(dict.builtVersion == previousLayout) {
+            for(size_t i = 0; i < batch.size(); i++) {
+                appendToDictionary(dict, batch[i]->*QUERY_STRING_FIELDS[d]);
+            }
+            dict.builtVersion = layoutVersion;
+        }
+    }
+    for(int c = 0; c < RANGE_COLUMN_COUNT; c++) {
+        if(rangeIndexes[c].builtVersion == previousData) {
+            rangeIndexes[c].pending.insert(rangeIndexes[c].pending.end(), batch.begin(), batch.end());
+            rangeIndexes[c].builtVersion = dataVersion;
         }
     }
     
-    auto end = high_resolution_clock::now();
-    double executionTime = duration_cast<microseconds>(end - start).count() / 1000.0;
-    
-    cout << "\n  ============================================================\n";
-    if(found) {
-        cout << "  Status: FOUND\n";
-        cout << "  Position: " << position << "\n";
-        cout << "  ------------------------------------------------------------\n";
-        cout << "  Order ID: " << arr[position-1]->orderID << "\n";
-        cout << "  Customer: " << arr[position-1]->customerName << "\n";
-        cout << "  Phone: " << arr[position-1]->phoneNumber << "\n";
-        cout << "  Product: " << arr[position-1]->productName << "\n";
-        cout << "  Category: " << arr[position-1]->productCategory << "\n";
-        cout << "  Total Amount: RM " << fixed << setprecision(2) << arr[position-1]->totalAmount << "\n";
+    BloomFilter& bloom = orderBloom;
+    if(bloom.blockCount == 0 || bloom.itemCount + batch.size() >= bloom.capacity * 2) {
+        rebuildBloomFilter();
     } else {
-        cout << "  Status: NOT FOUND\n";
+        for(size_t i = 0; i < batch.size(); i++) {
+            bloomAdd(batch[i]->orderID, batch[i]->customerName);
+        }
     }
-    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
-    cout << "  ============================================================\n";
-    
-    delete[] arr;
-    pause();
 }
 
-void optimizedLinearSearch() {
-    clearScreen();
-    int searchOrderID;
-    string searchName;
+// ---------------------------------------------------------------------
+// Streaming ingest
+// ---------------------------------------------------------------------
+
+long long wallClockMs() {
+    return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+// Parses the complete lines in text into a batch. A ninth field, if
+// present, is the sender's wall-clock time in ms and is used for lag.
+void parseIngestLines(StreamIngest& ingest, const string& text, IngestBatch& batch) {
+    size_t pos = 0;
+    while(pos < text.size()) {
+        size_t newline = text.find('\n', pos);
+        size_t end = (newline == string::npos) ? text.size() : newline;
+        string line = text.substr(pos, end - pos);
+        pos = end + 1;
+        if(!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);
+        }
+        if(line.empty()) {
+            continue;
+        }
+        Order* order = new Order();
+        if(!parseOrderLine(line, order)) {
+            delete order;
+            ingest.malformed++;
+            continue;
+        }
+        long long sent = -1;
+        size_t field = 0, bar = string::npos;
+        for(size_t i = 0; i < line.size(); i++) {
+            if(line[i] == '|' && ++field == 8) {
+                bar = i;
+                break;
+            }
+        }
+        if(bar != string::npos) {
+            sent = atoll(line.c_str() + bar + 1);
+        }
+        batch.orders.push_back(order);
+        batch.sentMs.push_back(sent > 0 ? sent : -1);
+    }
+}
+
+void queueIngestText(StreamIngest& ingest, const string& text) {
+    IngestBatch batch;
+    batch.readMs = wallClockMs();
+    parseIngestLines(ingest, text, batch);
+    if(!batch.orders.empty()) {
+        lock_guard<mutex> lock(ingest.lock);
+        ingest.ready.push_back(batch);
+    }
+}
+
+#ifndef _WIN32
+
+// Tail thread: polls the source for appended bytes and queues whole
+// lines. Every wait is bounded by INGEST_POLL_MS so stop is seen
+// promptly. The source ends at EOF on stdin, on a FIFO once its writer
+// has closed, and on a regular file unless follow is set (then it keeps
+// waiting for appends until stopped).
+void ingestWorker(StreamIngest* ingest, string source, bool fromStart, bool follow) {
+    int fd = STDIN_FILENO;
+    if(source != "-") {
+        fd = open(source.c_str(), O_RDONLY | O_NONBLOCK);    // a FIFO opens without a writer
+        if(fd < 0) {
+            ingest->finished = true;
+            return;
+        }
+    }
+    struct stat info;
+    bool regular = fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+    if(regular && follow && !fromStart) {
+        lseek(fd, 0, SEEK_END);
+    }
     
-    cout << "\n============================================================\n";
-    cout << "           OPTIMIZED LINEAR SEARCH (Sentinel)              \n";
-    cout << "============================================================\n";
-    cout << "  Enter Order ID: ";
+    vector<char> chunk(BACKGROUND_CHUNK_BYTES);
+    string pending;
+    bool sawData = false;
+    while(!ingest->stop) {
+        struct pollfd waitFor = {fd, POLLIN, 0};
+        int events = poll(&waitFor, 1, INGEST_POLL_MS);
+        if(events < 0 && errno != EINTR) {
+            break;
+        }
+        if(events <= 0) {
+            continue;
+        }
+        ssize_t got = read(fd, &chunk[0], chunk.size());
+        if(got < 0) {
+            if(errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if(got == 0) {
+            // A FIFO reads EOF until its first writer opens it, so it only
+            // ends once some data has come through
+            bool ended = regular ? !follow : (source == "-" || sawData);
+            if(ended) {
+                break;
+            }
+            this_thread::sleep_for(milliseconds(INGEST_POLL_MS));
+            continue;
+        }
+        sawData = true;
+        ingest->bytesRead += got;
+        pending.append(&chunk[0], (size_t)got);
+        size_t lastNewline = pending.rfind('\n');
+        if(lastNewline != string::npos) {
+            queueIngestText(*ingest, pending.substr(0, lastNewline + 1));
+            pending.erase(0, lastNewline + 1);
+        }
+    }
+    queueIngestText(*ingest, pending);    // a last line without a newline
+    if(fd != STDIN_FILENO) {
+        close(fd);
+    }
+    ingest->finished = true;
+}
+
+#else
+
+// Without poll() the tail reads through streams: a regular file is
+// polled for appends, and stdin is read until it closes (a blocking
+// read cannot see stop, so stdin may end a timed run late)
+void ingestWorker(StreamIngest* ingest, string source, bool fromStart, bool follow) {
+    if(source == "-") {
+        string line, text;
+        while(!ingest->stop && getline(cin, line)) {
+            ingest->bytesRead += (long long)line.size() + 1;
+            text += line + "\n";
+            if(cin.rdbuf()->in_avail() <= 0 || text.size() >= BACKGROUND_CHUNK_BYTES) {
+                queueIngestText(*ingest, text);
+                text.clear();
+            }
+        }
+        queueIngestText(*ingest, text);
+        ingest->finished = true;
+        return;
+    }
+    
+    ifstream file(source.c_str(), ios::binary);
+    if(file && follow && !fromStart) {
+        file.seekg(0, ios::end);
+    }
+    vector<char> chunk(BACKGROUND_CHUNK_BYTES);
+    string pending;
+    while(file && !ingest->stop) {
+        file.read(&chunk[0], chunk.size());
+        streamsize got = file.gcount();
+        if(got <= 0) {
+            if(!follow) {
+                break;
+            }
+            file.clear();   // at EOF: wait for the writer to append more
+            this_thread::sleep_for(milliseconds(INGEST_POLL_MS));
+            continue;
+        }
+        file.clear();
+        ingest->bytesRead += got;
+        pending.append(&chunk[0], (size_t)got);
+        size_t lastNewline = pending.rfind('\n');
+        if(lastNewline != string::npos) {
+            queueIngestText(*ingest, pending.substr(0, lastNewline + 1));
+            pending.erase(0, lastNewline + 1);
+        }
+    }
+    queueIngestText(*ingest, pending);    // a last line without a newline
+    ingest->finished = true;
+}
+
+#endif
+
+// Tails source ("-" for stdin) for the given number of seconds (0 = until
+// the source closes; a regular file is then read once to its end),
+// applying batches as they arrive and showing the ingest rate,
+// append-to-visible lag and running totals
+void runStreamIngest(const string& source, bool fromStart, double seconds) {
+    waitForBackgroundLoad();
+    StreamIngest ingest;
+    ingest.worker = thread(ingestWorker, &ingest, source, fromStart, seconds > 0);
+    
+    // Running aggregates, updated per batch rather than recomputed
+    Money runningSales = 0;
+    for(Order* current = orderList; current != nullptr; current = current->next) {
+        runningSales += current->totalAmount;
+    }
+    
+    auto start = high_resolution_clock::now();
+    auto lastRefresh = start;
+    long long rows = 0, batches = 0;
+    vector<long long> lags;
+    double applyTime = 0;
+    bool draining = false;
+    cout << "\n";
+    while(true) {
+        double elapsed = duration_cast<milliseconds>(high_resolution_clock::now() - start).count() / 1000.0;
+        if(!draining && ((seconds > 0 && elapsed >= seconds) || ingest.finished)) {
+            ingest.stop = true;
+            if(ingest.worker.joinable()) {
+                ingest.worker.join();
+            }
+            draining = true;   // one more pass picks up the last batches
+        }
+        vector<IngestBatch> ready;
+        {
+            lock_guard<mutex> lock(ingest.lock);
+            ready.swap(ingest.ready);
+        }
+        for(size_t b = 0; b < ready.size(); b++) {
+            ScopedTimer timer(TIMER_INGEST_APPLY);
+            applyOrderBatch(ready[b].orders);
+            for(size_t i = 0; i < ready[b].orders.size(); i++) {
+                runningSales += ready[b].orders[i]->totalAmount;
+            }
+            applyTime += timer.stop();
+            long long visibleMs = wallClockMs();
+            for(size_t i = 0; i < ready[b].orders.size(); i++) {
+                long long sent = ready[b].sentMs[i] > 0 ? ready[b].sentMs[i] : ready[b].readMs;
+                lags.push_back(max(0LL, visibleMs - sent));
+            }
+            rows += (long long)ready[b].orders.size();
+            batches++;
+        }
+        
+        auto now = high_resolution_clock::now();
+        if(draining || duration_cast<milliseconds>(now - lastRefresh).count() >= INGEST_REFRESH_MS) {
+            lastRefresh = now;
+            double runSeconds = max(duration_cast<microseconds>(now - start).count() / 1000000.0, 0.001);
+            cout << "\r  Ingested: " << rows << " rows (" << fixed << setprecision(0) << rows / runSeconds
+                 << " rows/s)  |  Lag: " << (lags.empty() ? 0 : lags.back()) << " ms"
+                 << "  |  Orders: " << orderCount << "  |  Sales: RM " << formatNumber(runningSales) << "   " << flush;
+        }
+        if(draining) {
+            break;
+        }
+        this_thread::sleep_for(milliseconds(INGEST_POLL_MS));
+    }
+    
+    double totalSeconds = duration_cast<microseconds>(high_resolution_clock::now() - start).count() / 1000000.0;
+    sort(lags.begin(), lags.end());
+    long long lagSum = 0;
+    for(size_t i = 0; i < lags.size(); i++) {
+        lagSum += lags[i];
+    }
+    cout << "\n\n  ============================================================\n";
+    cout << "  Source: " << (source == "-" ? "stdin" : source) << "\n";
+    cout << "  Rows Ingested: " << rows << " in " << batches << " batches";
+    if(ingest.malformed > 0) {
+        cout << " (" << ingest.malformed << " malformed lines skipped)";
+    }
+    cout << "\n  Bytes Read: " << ingest.bytesRead << "\n";
+    cout << "  Ingest Rate: " << fixed << setprecision(1) << (totalSeconds > 0 ? rows / totalSeconds : 0.0) << " rows/s\n";
+    if(!lags.empty()) {
+        cout << "  Lag (append to visible): avg " << setprecision(1) << (double)lagSum / lags.size()
+             << " ms, p99 " << lags[(size_t)(0.99 * (lags.size() - 1))]
+             << " ms, max " << lags.back() << " ms\n";
+    }
+    cout << "  Apply Time: " << fixed << setprecision(4) << applyTime << " ms ("
+         << (batches ? applyTime / batches : 0.0) << " ms per batch)\n";
+    cout << "  Total Orders: " << orderCount << "  |  Total Sales: RM " << formatNumber(runningSales) << "\n";
+    cout << "  ============================================================\n";
+}
+
+void streamIngestMenu() {
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "                  STREAMING INGEST                         \n";
+    cout << "============================================================\n";
+    cout << "  Tails a file or FIFO and applies appended order lines as\n";
+    cout << "  they arrive. Lines may carry a ninth field with the time\n";
+    cout << "  they were written (ms since epoch) to measure lag.\n\n";
+    
+    string source;
+    int startChoice;
+    double seconds;
+    cout << "  File or FIFO to tail: ";
+    cin >> source;
+    cout << "  Start from [1] end of file (new lines only) [2] beginning: ";
+    cin >> startChoice;
+    cout << "  Run for how many seconds: ";
+    cin >> seconds;
+    if(!cin || seconds <= 0) {
+        cin.clear();
+        cout << "\n  Invalid duration!\n";
+        pauseScreen();
+        return;
+    }
+    ifstream probe(source.c_str());
+    if(!probe) {
+        cout << "\n  Error: cannot open " << source << "\n";
+        pauseScreen();
+        return;
+    }
+    probe.close();
+    
+    runStreamIngest(source, startChoice == 2, seconds);
+    pauseScreen();
+}
+
+// Appends generated orders (copies of the loaded ones with new IDs and a
+// timestamp field) to path at the given rate, for exercising the tail
+void runFeedGenerator(const string& path, int rowsPerSecond, double seconds) {
+    OrderColumns& cols = getScanColumns();
+    if(cols.rows.empty()) {
+        cout << "No orders loaded to copy from\n";
+        return;
+    }
+    ofstream out(path.c_str(), ios::binary | ios::app);
+    if(!out) {
+        cout << "Cannot open " << path << "\n";
+        return;
+    }
+    int nextID = *max_element(cols.orderID.begin(), cols.orderID.end()) + 1;
+    auto start = high_resolution_clock::now();
+    long long written = 0;
+    size_t source = 0;
+    while(true) {
+        double elapsed = duration_cast<microseconds>(high_resolution_clock::now() - start).count() / 1000000.0;
+        if(elapsed >= seconds) {
+            break;
+        }
+        long long due = (long long)(elapsed * rowsPerSecond);
+        if(written < due) {
+            string lines;
+            long long now = wallClockMs();
+            for(; written < due; written++) {
+                const Order* order = cols.rows[source++ % cols.rows.size()];
+                lines += to_string(nextID++) + "|" + order->customerName + "|" + order->phoneNumber + "|"
+                       + order->productName + "|" + order->productCategory + "|" + to_string(order->quantity) + "|"
+                       + formatMoney(order->unitPrice) + "|" + formatMoney(order->totalAmount) + "|"
+                       + to_string(now) + "\n";
+            }
+            out << lines << flush;
+        }
+        this_thread::sleep_for(milliseconds(5));
+    }
+    cout << "Appended " << written << " orders to " << path << " in " << fixed << setprecision(2) << seconds << " s\n";
+}
+
+// ---------------------------------------------------------------------
+// Background loading
+// ---------------------------------------------------------------------
+
+// Reads the file in chunks, parses each chunk in parallel and queues the
+// batch for the menu thread, which links it in adoptLoadedOrders()
+void backgroundLoadWorker(string path) {
+    BackgroundLoad& load = backgroundLoad;
+    ScopedTimer timer(TIMER_LOAD);
+    ifstream file(path.c_str(), ios::binary);
+    
+    vector<char> chunk(BACKGROUND_CHUNK_BYTES);
+    string pending;
+    while(file && !load.cancel) {
+        file.read(&chunk[0], chunk.size());
+        streamsize got = file.gcount();
+        if(got <= 0) {
+            break;
+        }
+        pending.append(&chunk[0], (size_t)got);
+        load.bytesRead += got;
+        
+        size_t lastNewline = pending.rfind('\n');
+        if(lastNewline == string::npos) {
+            continue;
+        }
+        vector<Order*> batch = parseOrderBlock(pending.substr(0, lastNewline + 1));
+        pending.erase(0, lastNewline + 1);
+        load.rowsParsed += (long long)batch.size();
+        
+        lock_guard<mutex> lock(load.lock);
+        load.ready.push_back(batch);
+    }
+    if(!pending.empty() && !load.cancel) {
+        vector<Order*> batch = parseOrderBlock(pending);
+        load.rowsParsed += (long long)batch.size();
+        lock_guard<mutex> lock(load.lock);
+        load.ready.push_back(batch);
+    }
+    load.elapsedMs = timer.stop();
+    load.done = true;
+}
+
+void startBackgroundLoad(const string& path) {
+    BackgroundLoad& load = backgroundLoad;
+    ifstream file(path.c_str(), ios::binary | ios::ate);
+    if(!file) {
+        return;
+    }
+    load.totalBytes = (long long)file.tellg();
+    file.close();
+    
+    load.bytesRead = 0;
+    load.rowsParsed = 0;
+    load.done = false;
+    load.cancel = false;
+    load.active = true;
+    load.startTime = high_resolution_clock::now();
+    // Started here rather than lazily by the loader's first parallel parse
+    startTaskScheduler();
+    load.worker = thread(backgroundLoadWorker, path);
+}
+
+// Links any batches the loader has finished. Called from the menu thread only.
+void adoptLoadedOrders() {
+    BackgroundLoad& load = backgroundLoad;
+    if(!load.active) {
+        return;
+    }
+    // The worker queues its last batch before setting done, so when done is
+    // seen here the swap below takes everything it will ever queue
+    bool finished = load.done;
+    vector<vector<Order*> > batches;
+    {
+        lock_guard<mutex> lock(load.lock);
+        batches.swap(load.ready);
+    }
+    
+    for(size_t b = 0; b < batches.size(); b++) {
+        applyOrderBatch(batches[b]);
+    }
+    
+    if(finished) {
+        if(load.worker.joinable()) {
+            load.worker.join();
+        }
+        load.active = false;
+    }
+}
+
+bool backgroundLoadActive() {
+    adoptLoadedOrders();
+    return backgroundLoad.active;
+}
+
+void printLoadProgress() {
+    BackgroundLoad& load = backgroundLoad;
+    double seconds = duration_cast<microseconds>(high_resolution_clock::now() - load.startTime).count() / 1000000.0;
+    double percent = load.totalBytes > 0 ? load.bytesRead * 100.0 / load.totalBytes : 100.0;
+    cout << "  Loading: " << load.rowsParsed.load() << " rows ("
+         << fixed << setprecision(1) << percent << "%), "
+         << setprecision(0) << (seconds > 0 ? load.rowsParsed / seconds : 0.0) << " rows/s";
+}
+
+// Blocks until at least needed orders are linked or the load has finished
+void waitForRows(int needed) {
+    if(!backgroundLoadActive() || orderCount >= needed) {
+        return;
+    }
+    while(backgroundLoadActive() && orderCount < needed) {
+        cout << "\r";
+        printLoadProgress();
+        cout << "   " << flush;
+        this_thread::sleep_for(milliseconds(50));
+    }
+    cout << "\n";
+}
+
+void waitForBackgroundLoad() {
+    waitForRows(INT_MAX);
+}
+
+void printPartialDataNote() {
+    if(backgroundLoadActive()) {
+        cout << "  Note: still loading - results cover the first " << orderCount << " orders only.\n\n";
+    }
+}
+
+void stopBackgroundLoad() {
+    BackgroundLoad& load = backgroundLoad;
+    if(!load.active) {
+        return;
+    }
+    load.cancel = true;
+    load.worker.join();
+    adoptLoadedOrders();
+}
+
+void displayFirstNOrders(int n, bool sorted) {
+    // The sorted view needs every order; the unsorted one only the first n
+    waitForRows(sorted ? INT_MAX : n);
+    clearScreen();
+    
+    double sortTime = 0;
+    if(sorted) {
+        cout << "\n  Sorting data first...\n";
+        sortTime = quickSort().executionTime;
+    }
+    
+    // Only formatting is timed; sorting and terminal output are reported apart
+    ScopedTimer timer(TIMER_RENDER);
+    
+    int count = min(n, orderCount);
+    TableRenderer out;
+    rendererReserve(out, (size_t)(count + 8) * TABLE_ROW_WIDTH);
+    rendererText(out, "\n");
+    rendererText(out, sorted ? "SORTED" : "UNSORTED");
+    rendererText(out, " ORDERS (First ");
+    rendererInt(out, count, 0);
+    rendererText(out, ")\n");
+    renderOrderTableHeader(out);
+    
+    Order* current = orderList;
+    for(int i = 0; i < count; i++) {
+        renderOrderRow(out, current, i + 1);
+        current = current->next;
+    }
+    rendererText(out, TABLE_RULE);
+    
+    double executionTime = timer.stop();
+    
+    rendererFlush(out);
+    cout << "\n  Total orders displayed: " << count << " / " << orderCount << "\n";
+    if(sorted) {
+        cout << "  Sort Time: " << fixed << setprecision(4) << sortTime << " ms\n";
+    }
+    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+    pauseScreen();
+}
+
+// Jumps straight to any page through the order index (list order)
+void browseOrdersByPage() {
+    int page = 1;
+    TableRenderer out;
+    rendererReserve(out, (size_t)(BROWSE_PAGE_SIZE + 8) * TABLE_ROW_WIDTH);
+    
+    // While the startup load is running, pages past the loaded prefix wait for it
+    while(page >= 1) {
+        waitForRows(page * BROWSE_PAGE_SIZE);
+        OrderColumns& cols = getScanColumns();
+        int rowCount = (int)cols.rows.size();
+        int totalPages = (rowCount + BROWSE_PAGE_SIZE - 1) / BROWSE_PAGE_SIZE;
+        if(page > totalPages) {
+            break;
+        }
+        clearScreen();
+        ScopedTimer timer(TIMER_RENDER);
+        
+        int first = (page - 1) * BROWSE_PAGE_SIZE;
+        int last = min(first + BROWSE_PAGE_SIZE, rowCount);
+        out.length = 0;
+        rendererText(out, "\n  Page ");
+        rendererInt(out, page, 0);
+        rendererText(out, " of ");
+        rendererInt(out, totalPages, 0);
+        rendererText(out, "\n");
+        renderOrderTableHeader(out);
+        for(int i = first; i < last; i++) {
+            renderOrderRow(out, cols.rows[i], i + 1);
+        }
+        rendererText(out, TABLE_RULE);
+        
+        double executionTime = timer.stop();
+        rendererFlush(out);
+        
+        cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+        if(backgroundLoadActive()) {
+            cout << "  (still loading - more pages will follow)\n";
+        }
+        cout << "  Enter page number (1-" << totalPages << ", 0 to return): ";
+        if(!(cin >> page)) {
+            cin.clear();
+            break;
+        }
+    }
+}
+
+void displayOrderTableHeader() {
+    TableRenderer out;
+    renderOrderTableHeader(out);
+    rendererFlush(out);
+}
+
+void displayOrder(Order* order, int index) {
+    TableRenderer out;
+    renderOrderRow(out, order, index);
+    rendererFlush(out);
+}
+
+void renderOrderTableHeader(TableRenderer& out) {
+    rendererText(out, TABLE_RULE);
+    rendererText(out, " No  OrderID  Customer Name        Phone Number   Product Name         Category          Qty    UnitPrice  TotalAmt\n");
+    rendererText(out, TABLE_RULE);
+}
+
+void renderOrderRow(TableRenderer& out, Order* order, int index) {
+    rendererReserve(out, out.length + TABLE_ROW_WIDTH + 64);
+    rendererInt(out, index, 3);
+    rendererText(out, "    ");
+    rendererInt(out, order->orderID, 5);
+    rendererText(out, "   ");
+    rendererPadded(out, order->customerName, 20);
+    rendererText(out, " ");
+    rendererPadded(out, order->phoneNumber, 14);
+    rendererText(out, " ");
+    rendererPadded(out, order->productName, 20);
+    rendererText(out, " ");
+    rendererPadded(out, order->productCategory, 15);
+    rendererText(out, " ");
+    rendererInt(out, order->quantity, 4);
+    rendererText(out, " ");
+    rendererMoney(out, order->unitPrice, 10, false);
+    rendererText(out, " ");
+    rendererMoney(out, order->totalAmount, 11, false);
+    rendererText(out, "\n");
+}
+
+void rendererReserve(TableRenderer& out, size_t bytes) {
+    if(out.buffer.size() < bytes) {
+        out.buffer.resize(max(bytes, out.buffer.size() * 2));
+    }
+}
+
+void rendererAppend(TableRenderer& out, const char* text, size_t length) {
+    rendererReserve(out, out.length + length);
+    memcpy(&out.buffer[out.length], text, length);
+    out.length += length;
+}
+
+void rendererText(TableRenderer& out, const char* text) {
+    rendererAppend(out, text, strlen(text));
+}
+
+// Left-aligned, truncated or space-padded to exactly width characters
+void rendererPadded(TableRenderer& out, const string& text, int width) {
+    size_t used = min(text.size(), (size_t)width);
+    rendererReserve(out, out.length + width);
+    memcpy(&out.buffer[out.length], text.data(), used);
+    memset(&out.buffer[out.length + used], ' ', width - used);
+    out.length += width;
+}
+
+// Right-aligned in width characters (wider values are not truncated)
+void rendererInt(TableRenderer& out, long long value, int width) {
+    char digits[24];
+    int length = 0;
+    bool negative = value < 0;
+    unsigned long long magnitude = negative ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do {
+        digits[length++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while(magnitude != 0);
+    if(negative) {
+        digits[length++] = '-';
+    }
+    rendererReserve(out, out.length + max(width, length));
+    for(int pad = length; pad < width; pad++) {
+        out.buffer[out.length++] = ' ';
+    }
+    while(length > 0) {
+        out.buffer[out.length++] = digits[--length];
+    }
+}
+
+void rendererMoney(TableRenderer& out, Money value, int width, bool thousands) {
+    char text[40];
+    int length = formatMoneyChars(value, thousands, text);
+    rendererReserve(out, out.length + max(width, length));
+    for(int pad = length; pad < width; pad++) {
+        out.buffer[out.length++] = ' ';
+    }
+    memcpy(&out.buffer[out.length], text, length);
+    out.length += length;
+}
+
+void rendererFlush(TableRenderer& out) {
+    cout.write(out.buffer.data(), out.length);
+    out.length = 0;
+}
+
+// Writes cents as "1234.50" (or "1,234.50") into out.
+// Returns the number of characters written.
+int formatMoneyChars(Money cents, bool thousands, char* out) {
+    bool negative = cents < 0;
+    unsigned long long magnitude = negative ? 0ULL - (unsigned long long)cents : (unsigned long long)cents;
+    
+    // Build right to left, then reverse into out
+    char reversed[40];
+    int length = 0;
+    reversed[length++] = (char)('0' + magnitude % 10);
+    magnitude /= 10;
+    reversed[length++] = (char)('0' + magnitude % 10);
+    magnitude /= 10;
+    reversed[length++] = '.';
+    int groupDigits = 0;
+    do {
+        if(thousands && groupDigits == 3) {
+            reversed[length++] = ',';
+            groupDigits = 0;
+        }
+        reversed[length++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+        groupDigits++;
+    } while(magnitude != 0);
+    if(negative) {
+        reversed[length++] = '-';
+    }
+    for(int i = 0; i < length; i++) {
+        out[i] = reversed[length - 1 - i];
+    }
+    return length;
+}
+
+SortStats insertionSort() {
+    SortStats stats;
+    stats.swapCount = 0;
+    
+    Order** arr = convertToArray();
+    long long comparisons = 0;
+    ScopedTimer timer(TIMER_INSERTION_SORT);
+    
+    for(int i = 1; i < orderCount; i++) {
+        Order* key = arr[i];
+        int j = i - 1;
+        
+        while(j >= 0) {
+            comparisons++;
+            if(!compareOrders(key, arr[j])) {
+                break;
+            }
+            arr[j + 1] = arr[j];
+            stats.swapCount++;
+            j--;
+        }
+        arr[j + 1] = key;
+    }
+    
+    stats.executionTime = timer.stop();
+    countStat(STAT_COMPARISONS, comparisons);
+    countStat(STAT_SWAPS, stats.swapCount);
+    
+    updateListFromArray(arr);
+    delete[] arr;
+    
+    return stats;
+}
+
+SortStats quickSort() {
+    SortStats stats;
+    stats.swapCount = 0;
+    
+    Order** arr = convertToArray();
+    
+    ScopedTimer timer(TIMER_QUICK_SORT);
+    quickSortRecursive(arr, 0, orderCount - 1, stats.swapCount);
+    stats.executionTime = timer.stop();
+    countStat(STAT_SWAPS, stats.swapCount);
+    
+    updateListFromArray(arr);
+    delete[] arr;
+    
+    return stats;
+}
+
+// Fork-join quick sort: after each partition the left half becomes a task
+// that idle workers can steal while this thread continues on the right
+void parallelQuickSortRecursive(Order** arr, int low, int high, atomic<long long>& swapCount) {
+    if(high - low < PARALLEL_SORT_CUTOFF) {
+        long long localSwaps = 0;
+        quickSortRecursive(arr, low, high, localSwaps);
+        swapCount += localSwaps;
+        return;
+    }
+    long long localSwaps = 0;
+    int pi = partition(arr, low, high, localSwaps);
+    swapCount += localSwaps;
+    
+    TaskGroup group;
+    spawnTask(group, [arr, low, pi, &swapCount]() {
+        parallelQuickSortRecursive(arr, low, pi - 1, swapCount);
+    });
+    parallelQuickSortRecursive(arr, pi + 1, high, swapCount);
+    waitTaskGroup(group);
+}
+
+SortStats parallelQuickSort() {
+    SortStats stats;
+    atomic<long long> swapCount(0);
+    
+    Order** arr = convertToArray();
+    startTaskScheduler();
+    
+    ScopedTimer timer(TIMER_PARALLEL_SORT);
+    parallelQuickSortRecursive(arr, 0, orderCount - 1, swapCount);
+    stats.executionTime = timer.stop();
+    stats.swapCount = swapCount;
+    countStat(STAT_SWAPS, stats.swapCount);
+    
+    updateListFromArray(arr);
+    delete[] arr;
+    
+    return stats;
+}
+
+void quickSortRecursive(Order** arr, int low, int high, long long& swapCount) {
+    if(low < high) {
+        int pi = partition(arr, low, high, swapCount);
+        quickSortRecursive(arr, low, pi - 1, swapCount);
+        quickSortRecursive(arr, pi + 1, high, swapCount);
+    }
+}
+
+int partition(Order** arr, int low, int high, long long& swapCount) {
+    Order* pivot = arr[high];
+    int i = low - 1;
+    countStat(STAT_COMPARISONS, high - low);
+    
+    for(int j = low; j < high; j++) {
+        if(compareOrders(arr[j], pivot)) {
+            i++;
+            swapOrders(&arr[i], &arr[j]);
+            swapCount++;
+        }
+    }
+    swapOrders(&arr[i + 1], &arr[high]);
+    swapCount++;
+    return i + 1;
+}
+
+bool compareOrders(const Order* a, const Order* b) {
+    if(a->totalAmount != b->totalAmount) {
+        return a->totalAmount > b->totalAmount;
+    }
+    return a->orderID < b->orderID;
+}
+
+void swapOrders(Order** a, Order** b) {
+    Order* temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+Order** convertToArray() {
+    Order** arr = new Order*[orderCount];
+    countStat(STAT_ALLOCATIONS);
+    Order* current = orderList;
+    int index = 0;
+    
+    while(current != nullptr) {
+        arr[index++] = current;
+        current = current->next;
+    }
+    
+    return arr;
+}
+
+void updateListFromArray(Order** arr) {
+    layoutVersion++;
+    orderList = arr[0];
+    for(int i = 0; i < orderCount - 1; i++) {
+        arr[i]->next = arr[i + 1];
+    }
+    arr[orderCount - 1]->next = nullptr;
+    orderTail = arr[orderCount - 1];
+}
+
+// ---------------------------------------------------------------------
+// Snapshots
+// ---------------------------------------------------------------------
+
+OrderSnapshot takeSnapshot() {
+    OrderSnapshot snapshot;
+    snapshot.order.reserve(orderCount);
+    for(Order* current = orderList; current != nullptr; current = current->next) {
+        snapshot.order.push_back(current);
+    }
+    snapshot.dataVersion = dataVersion;
+    snapshot.takenAt = duration_cast<microseconds>(high_resolution_clock::now() - programStart).count() / 1000.0;
+    return snapshot;
+}
+
+// Relinks the list in the saved order. Fails (and changes nothing) if
+// orders were loaded, added or freed since the snapshot was taken.
+bool restoreSnapshot(const OrderSnapshot& snapshot) {
+    if(snapshot.dataVersion != dataVersion || (int)snapshot.order.size() != orderCount) {
+        return false;
+    }
+    if(orderCount > 0) {
+        updateListFromArray(const_cast<Order**>(&snapshot.order[0]));
+    }
+    return true;
+}
+
+bool listIsSorted() {
+    for(Order* current = orderList; current != nullptr && current->next != nullptr; current = current->next) {
+        if(compareOrders(current->next, current)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs every sort on the same input: the list is restored from a snapshot
+// before each run and once more at the end, so the comparison leaves the
+// data as it found it
+void compareSortAlgorithms() {
+    clearScreen();
+    cout << "\n  Comparing Sorting Algorithms...\n\n";
+    
+    struct SortAlgorithm {
+        const char* name;
+        SortStats (*run)();
+    };
+    const SortAlgorithm algorithms[3] = {
+        {"Insertion Sort", insertionSort},
+        {"Quick Sort", quickSort},
+        {"Parallel Quick Sort", parallelQuickSort}
+    };
+    const int algorithmCount = 3;
+    
+    OrderSnapshot original = takeSnapshot();
+    SortStats results[algorithmCount];
+    double restoreTimes[algorithmCount];
+    bool sorted[algorithmCount];
+    bool identical = true;
+    vector<Order*> firstResult;
+    
+    for(int a = 0; a < algorithmCount; a++) {
+        auto start = high_resolution_clock::now();
+        restoreSnapshot(original);
+        restoreTimes[a] = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() / 1000000.0;
+        
+        cout << "  Running " << algorithms[a].name << " on the original order...\n";
+        results[a] = algorithms[a].run();
+        sorted[a] = listIsSorted();
+        
+        OrderSnapshot result = takeSnapshot();
+        if(a == 0) {
+            firstResult = result.order;
+        } else if(result.order != firstResult) {
+            identical = false;
+        }
+    }
+    auto start = high_resolution_clock::now();
+    restoreSnapshot(original);
+    double finalRestore = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() / 1000000.0;
+    
+    cout << "\n  ==============================================================================\n";
+    cout << "                        SORTING ALGORITHMS COMPARISON                           \n";
+    cout << "  ==============================================================================\n";
+    cout << "  +----------------------+-----------------+-----------------+--------------+--------+\n";
+    cout << "  | Algorithm            | Time (ms)       | Swaps           | Restore (ms) | Sorted |\n";
+    cout << "  +----------------------+-----------------+-----------------+--------------+--------+\n";
+    int fastest = 0;
+    for(int a = 0; a < algorithmCount; a++) {
+        cout << "  | " << setw(20) << left << algorithms[a].name
+             << " | " << setw(15) << right << fixed << setprecision(2) << results[a].executionTime
+             << " | " << setw(15) << results[a].swapCount
+             << " | " << setw(12) << setprecision(4) << restoreTimes[a]
+             << " | " << setw(6) << left << (sorted[a] ? "Yes" : "No") << " |\n";
+        if(results[a].executionTime < results[fastest].executionTime) {
+            fastest = a;
+        }
+    }
+    cout << "  +----------------------+-----------------+-----------------+--------------+--------+\n";
+    cout << "\n  Every algorithm started from the same " << orderCount << " orders"
+         << (identical ? " and produced the same order.\n" : ", but the results differ!\n");
+    for(int a = 0; a < algorithmCount; a++) {
+        if(a != fastest && results[a].executionTime > 0) {
+            double improvement = (results[a].executionTime - results[fastest].executionTime) / results[a].executionTime * 100;
+            cout << "  " << algorithms[fastest].name << " is faster than " << algorithms[a].name
+                 << " by " << fixed << setprecision(2) << improvement << "%\n";
+        }
+    }
+    cout << "  Original order restored in " << fixed << setprecision(4) << finalRestore << " ms\n";
+    cout << "  ==============================================================================\n";
+    pauseScreen();
+}
+
+void saveSnapshotScreen() {
+    waitForBackgroundLoad();
+    auto start = high_resolution_clock::now();
+    savedSnapshot = takeSnapshot();
+    double executionTime = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() / 1000000.0;
+    cout << "\n  Snapshot of the current order saved (" << savedSnapshot.order.size() << " orders).\n";
+    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+    pauseScreen();
+}
+
+void restoreSnapshotScreen() {
+    if(savedSnapshot.dataVersion < 0) {
+        cout << "\n  No snapshot saved yet!\n";
+        pauseScreen();
+        return;
+    }
+    auto start = high_resolution_clock::now();
+    bool restored = restoreSnapshot(savedSnapshot);
+    double executionTime = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() / 1000000.0;
+    if(!restored) {
+        cout << "\n  The orders have been reloaded or changed since the snapshot; it can no longer be restored.\n";
+    } else {
+        cout << "\n  Order restored to the snapshot taken at " << fixed << setprecision(0)
+             << savedSnapshot.takenAt << " ms.\n";
+        cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+    }
+    pauseScreen();
+}
+
+void linearSearch() {
+    clearScreen();
+    int searchOrderID;
+    string searchName;
+    
+    cout << "\n============================================================\n";
+    cout << "                     LINEAR SEARCH                         \n";
+    cout << "============================================================\n";
+    cout << "  Enter Order ID: ";
+    cin >> searchOrderID;
+    cin.ignore();
+    cout << "  Enter Customer Name: ";
+    getline(cin, searchName);
+    
+    auto bloomStart = high_resolution_clock::now();
+    if(!bloomMayContain(searchOrderID, searchName)) {
+        reportBloomReject(bloomStart);
+        return;
+    }
+    
+    ScopedTimer timer(TIMER_LINEAR_SEARCH);
+    
+    Order* current = orderList;
+    bool found = false;
+    int position = 0;
+    
+    while(current != nullptr) {
+        position++;
+        if(current->orderID == searchOrderID && current->customerName == searchName) {
+            found = true;
+            break;
+        }
+        current = current->next;
+    }
+    
+    double executionTime = timer.stop();
+    countStat(STAT_COMPARISONS, position);
+    bloomRecordOutcome(found);
+    
+    cout << "\n  ============================================================\n";
+    if(found) {
+        cout << "  Status: FOUND\n";
+        cout << "  Position: " << position << "\n";
+        cout << "  ------------------------------------------------------------\n";
+        cout << "  Order ID: " << current->orderID << "\n";
+        cout << "  Customer: " << current->customerName << "\n";
+        cout << "  Phone: " << current->phoneNumber << "\n";
+        cout << "  Product: " << current->productName << "\n";
+        cout << "  Category: " << current->productCategory << "\n";
+        cout << "  Total Amount: RM " << formatMoney(current->totalAmount) << "\n";
+    } else {
+        cout << "  Status: NOT FOUND\n";
+    }
+    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+    cout << "  ============================================================\n";
+    pauseScreen();
+}
+
+// Orders by (Order ID, Customer Name), the binary search key
+bool compareOrderKeys(const Order* a, const Order* b) {
+    if(a->orderID != b->orderID) {
+        return a->orderID < b->orderID;
+    }
+    return a->customerName < b->customerName;
+}
+
+void binarySearch() {
+    clearScreen();
+    int searchOrderID;
+    string searchName;
+    
+    cout << "\n============================================================\n";
+    cout << "                     BINARY SEARCH                         \n";
+    cout << "============================================================\n";
+    cout << "  Note: An array sorted by Order ID is built first (the list order is kept).\n\n";
+    cout << "  Enter Order ID: ";
+    cin >> searchOrderID;
+    cin.ignore();
+    cout << "  Enter Customer Name: ";
+    getline(cin, searchName);
+    
+    auto bloomStart = high_resolution_clock::now();
+    if(!bloomMayContain(searchOrderID, searchName)) {
+        reportBloomReject(bloomStart);
+        return;
+    }
+    
+    // Search on the key the array is ordered by; the list itself is sorted
+    // by Total Amount, which a binary search on Order ID cannot use
+    Order** arr = convertToArray();
+    sort(arr, arr + orderCount, compareOrderKeys);
+    
+    ScopedTimer timer(TIMER_BINARY_SEARCH);
+    
+    int left = 0, right = orderCount - 1;
+    bool found = false;
+    int position = -1;
+    long long probes = 0;
+    
+    while(left <= right) {
+        int mid = left + (right - left) / 2;
+        probes++;
+        
+        if(arr[mid]->orderID == searchOrderID && arr[mid]->customerName == searchName) {
+            found = true;
+            position = mid + 1;
+            break;
+        }
+        
+        if(arr[mid]->orderID < searchOrderID ||
+           (arr[mid]->orderID == searchOrderID && arr[mid]->customerName < searchName)) {
+            left = mid + 1;
+        } else {
+            right = mid - 1;
+        }
+    }
+    
+    double executionTime = timer.stop();
+    countStat(STAT_INDEX_PROBES, probes);
+    bloomRecordOutcome(found);
+    
+    cout << "\n  ============================================================\n";
+    if(found) {
+        cout << "  Status: FOUND\n";
+        cout << "  Position: " << position << "\n";
+        cout << "  ------------------------------------------------------------\n";
+        cout << "  Order ID: " << arr[position-1]->orderID << "\n";
+        cout << "  Customer: " << arr[position-1]->customerName << "\n";
+        cout << "  Phone: " << arr[position-1]->phoneNumber << "\n";
+        cout << "  Product: " << arr[position-1]->productName << "\n";
+        cout << "  Category: " << arr[position-1]->productCategory << "\n";
+        cout << "  Total Amount: RM " << formatMoney(arr[position-1]->totalAmount) << "\n";
+    } else {
+        cout << "  Status: NOT FOUND\n";
+    }
+    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+    cout << "  ============================================================\n";
+    
+    delete[] arr;
+    pauseScreen();
+}
+
+void optimizedLinearSearch() {
+    clearScreen();
+    int searchOrderID;
+    string searchName;
+    
+    cout << "\n============================================================\n";
+    cout << "           OPTIMIZED LINEAR SEARCH (Sentinel)              \n";
+    cout << "============================================================\n";
+    cout << "  Enter Order ID: ";
+    cin >> searchOrderID;
+    cin.ignore();
+    cout << "  Enter Customer Name: ";
+    getline(cin, searchName);
+    
+    auto bloomStart = high_resolution_clock::now();
+    if(!bloomMayContain(searchOrderID, searchName)) {
+        reportBloomReject(bloomStart);
+        return;
+    }
+    
+    Order** arr = convertToArray();
+    Order sentinel;
+    sentinel.orderID = searchOrderID;
+    sentinel.customerName = searchName;
+    
+    Order** tempArr = new Order*[orderCount + 1];
+    for(int i = 0; i < orderCount; i++) {
+        tempArr[i] = arr[i];
+    }
+    tempArr[orderCount] = &sentinel;
+    countStat(STAT_ALLOCATIONS);
+    
+    // Timed region covers the search only, not building the array
+    ScopedTimer timer(TIMER_SENTINEL_SEARCH);
+    
+    int i = 0;
+    while(!(tempArr[i]->orderID == searchOrderID && tempArr[i]->customerName == searchName)) {
+        i++;
+    }
+    
+    bool found = (i < orderCount);
+    
+    double executionTime = timer.stop();
+    countStat(STAT_COMPARISONS, i + 1);
+    bloomRecordOutcome(found);
+    
+    cout << "\n  ============================================================\n";
+    if(found) {
+        cout << "  Status: FOUND\n";
+        cout << "  Position: " << (i + 1) << "\n";
+        cout << "  ------------------------------------------------------------\n";
+        cout << "  Order ID: " << tempArr[i]->orderID << "\n";
+        cout << "  Customer: " << tempArr[i]->customerName << "\n";
+        cout << "  Phone: " << tempArr[i]->phoneNumber << "\n";
+        cout << "  Product: " << tempArr[i]->productName << "\n";
+        cout << "  Category: " << tempArr[i]->productCategory << "\n";
+        cout << "  Total Amount: RM " << formatMoney(tempArr[i]->totalAmount) << "\n";
+    } else {
+        cout << "  Status: NOT FOUND\n";
+    }
+    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+    cout << "  Improvement: Sentinel technique eliminates boundary checking\n";
+    cout << "  ============================================================\n";
+    
+    delete[] arr;
+    delete[] tempArr;
+    pauseScreen();
+}
+
+
+long long rangeColumnKey(Order* order, RangeColumn column) {
+    switch(column) {
+        case RANGE_UNIT_PRICE: return order->unitPrice;
+        case RANGE_QUANTITY: return order->quantity;
+        default: return order->totalAmount;
+    }
+}
+
+// Converts a typed bound (RM or items) to index key units. Quantity bounds
+// are rounded inwards so 2.5..7.5 means 3..7. The bound must pass
+// moneyInputInRange.
+long long rangeInputKey(RangeColumn column, double value, bool isMax) {
+    if(column == RANGE_QUANTITY) {
+        return (long long)(isMax ? floor(value) : ceil(value));
+    }
+    return toCents(value);
+}
+
+bool compareRangeEntries(const pair<long long, Order*>& a, const pair<long long, Order*>& b) {
+    if(a.first != b.first) {
+        return a.first < b.first;
+    }
+    return a.second->orderID < b.second->orderID;
+}
+
+// Returns the index for a column, rebuilding it if the data has changed
+// and merging in any rows ingested since it was last read
+RangeIndex& getRangeIndex(RangeColumn column) {
+    RangeIndex& index = rangeIndexes[column];
+    if(index.builtVersion == dataVersion) {
+        if(!index.pending.empty()) {
+            ScopedTimer timer(TIMER_INDEX_BUILD);
+            mergeIntoRangeIndex(index, index.pending, column);
+            index.pending.clear();
+            index.buildTime = timer.stop();
+        }
+        return index;
+    }
+    
+    ScopedTimer timer(TIMER_INDEX_BUILD);
+    index.pending.clear();
+    
+    vector<Order*> rows;
+    rows.reserve(orderCount);
+    for(Order* current = orderList; current != nullptr; current = current->next) {
+        rows.push_back(current);
+    }
+    buildRangeIndex(index, rows, column);
+    index.builtVersion = dataVersion;
+    index.buildTime = timer.stop();
+    return index;
+}
+
+// Fills index with rows sorted by the column, plus the prefix sums
+void buildRangeIndex(RangeIndex& index, const vector<Order*>& rows, RangeColumn column) {
+    vector<pair<long long, Order*> > entries;
+    entries.reserve(rows.size());
+    for(size_t i = 0; i < rows.size(); i++) {
+        entries.push_back(make_pair(rangeColumnKey(rows[i], column), rows[i]));
+    }
+    sort(entries.begin(), entries.end(), compareRangeEntries);
+    
+    size_t n = entries.size();
+    index.rows.resize(n);
+    index.keys.resize(n);
+    index.keyPrefix.assign(n + 1, 0);
+    index.amountPrefix.assign(n + 1, 0);
+    for(size_t i = 0; i < n; i++) {
+        index.keys[i] = entries[i].first;
+        index.rows[i] = entries[i].second;
+        index.keyPrefix[i + 1] = index.keyPrefix[i] + entries[i].first;
+        index.amountPrefix[i + 1] = index.amountPrefix[i] + entries[i].second->totalAmount;
+    }
+}
+
+// Merges a batch of new rows into a built index in O(n + k log k)
+void mergeIntoRangeIndex(RangeIndex& index, const vector<Order*>& batch, RangeColumn column) {
+    vector<pair<long long, Order*> > added;
+    added.reserve(batch.size());
+    for(size_t i = 0; i < batch.size(); i++) {
+        added.push_back(make_pair(rangeColumnKey(batch[i], column), batch[i]));
+    }
+    sort(added.begin(), added.end(), compareRangeEntries);
+    
+    size_t n = index.rows.size() + added.size();
+    vector<Order*> rows;
+    vector<long long> keys;
+    rows.reserve(n);
+    keys.reserve(n);
+    size_t a = 0, b = 0;
+    while(a < index.rows.size() || b < added.size()) {
+        bool takeOld = b == added.size() ||
+            (a < index.rows.size() && !compareRangeEntries(added[b], make_pair(index.keys[a], index.rows[a])));
+        if(takeOld) {
+            keys.push_back(index.keys[a]);
+            rows.push_back(index.rows[a++]);
+        } else {
+            keys.push_back(added[b].first);
+            rows.push_back(added[b++].second);
+        }
+    }
+    index.rows.swap(rows);
+    index.keys.swap(keys);
+    index.keyPrefix.assign(n + 1, 0);
+    index.amountPrefix.assign(n + 1, 0);
+    for(size_t i = 0; i < n; i++) {
+        index.keyPrefix[i + 1] = index.keyPrefix[i] + index.keys[i];
+        index.amountPrefix[i + 1] = index.amountPrefix[i] + index.rows[i]->totalAmount;
+    }
+}
+
+// Locates [first, last) of the rows whose key lies in [minKey, maxKey]
+void findRangeBounds(const RangeIndex& index, long long minKey, long long maxKey, size_t& first, size_t& last) {
+    countStat(STAT_INDEX_PROBES, 2);
+    first = lower_bound(index.keys.begin(), index.keys.end(), minKey) - index.keys.begin();
+    last = upper_bound(index.keys.begin(), index.keys.end(), maxKey) - index.keys.begin();
+    if(last < first) {
+        last = first;
+    }
+}
+
+void rangeQuery() {
+    clearScreen();
+    int columnChoice;
+    double minValue, maxValue;
+    
+    cout << "\n============================================================\n";
+    cout << "                 RANGE QUERY (INDEXED)                     \n";
+    cout << "============================================================\n";
+    cout << "  [1] Total Amount\n";
+    cout << "  [2] Unit Price\n";
+    cout << "  [3] Quantity\n";
+    cout << "------------------------------------------------------------\n";
+    cout << "  Select column: ";
+    cin >> columnChoice;
+    if(columnChoice < 1 || columnChoice > 3) {
+        cout << "\n  Invalid choice!\n";
+        pauseScreen();
+        return;
+    }
+    RangeColumn column = (columnChoice == 1) ? RANGE_TOTAL_AMOUNT
+                       : (columnChoice == 2) ? RANGE_UNIT_PRICE : RANGE_QUANTITY;
+    const char* columnName = (column == RANGE_TOTAL_AMOUNT) ? "Total Amount"
+                           : (column == RANGE_UNIT_PRICE) ? "Unit Price" : "Quantity";
+    
+    cout << "  Enter minimum (inclusive): ";
+    cin >> minValue;
+    cout << "  Enter maximum (inclusive): ";
+    cin >> maxValue;
+    if(!cin || minValue > maxValue || !moneyInputInRange(minValue) || !moneyInputInRange(maxValue)) {
+        cin.clear();
+        cout << "\n  Invalid range!\n";
+        pauseScreen();
+        return;
+    }
+    
+    bool rebuilt = (rangeIndexes[column].builtVersion != dataVersion);
+    RangeIndex& index = getRangeIndex(column);
+    
+    ScopedTimer timer(TIMER_RANGE_QUERY);
+    
+    size_t first, last;
+    findRangeBounds(index, rangeInputKey(column, minValue, false), rangeInputKey(column, maxValue, true), first, last);
+    size_t matchCount = last - first;
+    long long columnSum = index.keyPrefix[last] - index.keyPrefix[first];
+    Money amountSum = index.amountPrefix[last] - index.amountPrefix[first];
+    
+    double executionTime = timer.stop();
+    
+    cout << "\n  ============================================================\n";
+    cout << "  Column: " << columnName << "  [" << fixed << setprecision(2) << minValue
+         << " .. " << maxValue << "]\n";
+    cout << "  Matching Orders: " << matchCount << " / " << orderCount << "\n";
+    if(column == RANGE_QUANTITY) {
+        cout << "  Sum of Quantity: " << columnSum << "\n";
+    } else {
+        cout << "  Sum of " << columnName << ": RM " << formatNumber(columnSum) << "\n";
+    }
+    if(column != RANGE_TOTAL_AMOUNT) {
+        cout << "  Sum of Total Amount: RM " << formatNumber(amountSum) << "\n";
+    }
+    if(rebuilt) {
+        cout << "  Index Build Time: " << fixed << setprecision(4) << index.buildTime << " ms\n";
+    }
+    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+    cout << "  ============================================================\n";
+    
+    if(matchCount == 0) {
+        pauseScreen();
+        return;
+    }
+    
+    int totalPages = (int)((matchCount + RANGE_PAGE_SIZE - 1) / RANGE_PAGE_SIZE);
+    int page = 1;
+    while(page >= 1 && page <= totalPages) {
+        size_t pageStart = first + (size_t)(page - 1) * RANGE_PAGE_SIZE;
+        size_t pageEnd = min(pageStart + RANGE_PAGE_SIZE, last);
+        
+        TableRenderer out;
+        rendererReserve(out, (size_t)(RANGE_PAGE_SIZE + 8) * TABLE_ROW_WIDTH);
+        rendererText(out, "\n  Page ");
+        rendererInt(out, page, 0);
+        rendererText(out, " of ");
+        rendererInt(out, totalPages, 0);
+        rendererText(out, "\n");
+        renderOrderTableHeader(out);
+        for(size_t i = pageStart; i < pageEnd; i++) {
+            renderOrderRow(out, index.rows[i], (int)(i - first + 1));
+        }
+        rendererText(out, TABLE_RULE);
+        rendererFlush(out);
+        
+        cout << "  Enter page number (0 to return): ";
+        if(!(cin >> page)) {
+            cin.clear();
+            break;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------
+// Scan kernels
+// ---------------------------------------------------------------------
+
+OrderColumns& getScanColumns() {
+    OrderColumns& cols = scanColumns;
+    if(cols.builtVersion == layoutVersion) {
+        return cols;
+    }
+    
+    cols.rows.clear();
+    cols.orderID.clear();
+    cols.quantity.clear();
+    cols.unitPrice.clear();
+    cols.totalAmount.clear();
+    cols.rows.reserve(orderCount);
+    cols.orderID.reserve(orderCount);
+    cols.quantity.reserve(orderCount);
+    cols.unitPrice.reserve(orderCount);
+    cols.totalAmount.reserve(orderCount);
+    
+    for(Order* current = orderList; current != nullptr; current = current->next) {
+        cols.rows.push_back(current);
+        cols.orderID.push_back(current->orderID);
+        cols.quantity.push_back(current->quantity);
+        cols.unitPrice.push_back(current->unitPrice);
+        cols.totalAmount.push_back(current->totalAmount);
+    }
+    cols.builtVersion = layoutVersion;
+    return cols;
+}
+
+int scalarFindInt32(const int* data, int n, int start, int value) {
+    for(int i = start; i < n; i++) {
+        if(data[i] == value) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int scalarCountRangeInt32(const int* data, int n, int lo, int hi) {
+    int count = 0;
+    for(int i = 0; i < n; i++) {
+        count += (data[i] >= lo && data[i] <= hi);
+    }
+    return count;
+}
+
+void scalarSumMinMaxInt64(const long long* data, int n, long long& sum, long long& minValue, long long& maxValue) {
+    sum = 0;
+    minValue = (n > 0) ? data[0] : 0;
+    maxValue = minValue;
+    for(int i = 0; i < n; i++) {
+        sum += data[i];
+        if(data[i] < minValue) minValue = data[i];
+        if(data[i] > maxValue) maxValue = data[i];
+    }
+}
+
+#ifdef OSOMS_X86_SIMD
+
+__attribute__((target("sse4.1")))
+int sseFindInt32(const int* data, int n, int start, int value) {
+    __m128i needle = _mm_set1_epi32(value);
+    int i = start;
+    for(; i + 4 <= n; i += 4) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block, needle)));
+        if(mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return scalarFindInt32(data, n, i, value);
+}
+
+__attribute__((target("sse4.1")))
+int sseCountRangeInt32(const int* data, int n, int lo, int hi) {
+    __m128i low = _mm_set1_epi32(lo);
+    __m128i high = _mm_set1_epi32(hi);
+    int count = 0;
+    int i = 0;
+    for(; i + 4 <= n; i += 4) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        // Outside the range when lo > x or x > hi
+        __m128i outside = _mm_or_si128(_mm_cmpgt_epi32(low, block), _mm_cmpgt_epi32(block, high));
+        count += 4 - __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(outside)));
+    }
+    for(; i < n; i++) {
+        count += (data[i] >= lo && data[i] <= hi);
+    }
+    return count;
+}
+
+// SSE4.1 has no 64-bit compare, so a lane is "less" when the sign of the
+// difference is set. Money values are far from 2^62, so a - b cannot overflow.
+__attribute__((target("sse4.1")))
+inline __m128i sseLessThanInt64(__m128i a, __m128i b) {
+    __m128i difference = _mm_sub_epi64(a, b);
+    return _mm_shuffle_epi32(_mm_srai_epi32(difference, 31), _MM_SHUFFLE(3, 3, 1, 1));
+}
+
+__attribute__((target("sse4.1")))
+void sseSumMinMaxInt64(const long long* data, int n, long long& sum, long long& minValue, long long& maxValue) {
+    if(n < 2) {
+        scalarSumMinMaxInt64(data, n, sum, minValue, maxValue);
+        return;
+    }
+    __m128i acc = _mm_setzero_si128();
+    __m128i lo = _mm_set1_epi64x(data[0]);
+    __m128i hi = lo;
+    int i = 0;
+    for(; i + 2 <= n; i += 2) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(data + i));
+        acc = _mm_add_epi64(acc, block);
+        lo = _mm_blendv_epi8(lo, block, sseLessThanInt64(block, lo));
+        hi = _mm_blendv_epi8(hi, block, sseLessThanInt64(hi, block));
+    }
+    long long accParts[2], loParts[2], hiParts[2];
+    _mm_storeu_si128((__m128i*)accParts, acc);
+    _mm_storeu_si128((__m128i*)loParts, lo);
+    _mm_storeu_si128((__m128i*)hiParts, hi);
+    sum = accParts[0] + accParts[1];
+    minValue = min(loParts[0], loParts[1]);
+    maxValue = max(hiParts[0], hiParts[1]);
+    for(; i < n; i++) {
+        sum += data[i];
+        minValue = min(minValue, data[i]);
+        maxValue = max(maxValue, data[i]);
+    }
+}
+
+__attribute__((target("avx2")))
+int avx2FindInt32(const int* data, int n, int start, int value) {
+    __m256i needle = _mm256_set1_epi32(value);
+    int i = start;
+    for(; i + 8 <= n; i += 8) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, needle)));
+        if(mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+    return scalarFindInt32(data, n, i, value);
+}
+
+__attribute__((target("avx2")))
+int avx2CountRangeInt32(const int* data, int n, int lo, int hi) {
+    __m256i low = _mm256_set1_epi32(lo);
+    __m256i high = _mm256_set1_epi32(hi);
+    int count = 0;
+    int i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(low, block), _mm256_cmpgt_epi32(block, high));
+        count += 8 - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(outside)));
+    }
+    for(; i < n; i++) {
+        count += (data[i] >= lo && data[i] <= hi);
+    }
+    return count;
+}
+
+__attribute__((target("avx2")))
+void avx2SumMinMaxInt64(const long long* data, int n, long long& sum, long long& minValue, long long& maxValue) {
+    if(n < 4) {
+        scalarSumMinMaxInt64(data, n, sum, minValue, maxValue);
+        return;
+    }
+    __m256i acc = _mm256_setzero_si256();
+    __m256i lo = _mm256_set1_epi64x(data[0]);
+    __m256i hi = lo;
+    int i = 0;
+    for(; i + 4 <= n; i += 4) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)(data + i));
+        acc = _mm256_add_epi64(acc, block);
+        lo = _mm256_blendv_epi8(lo, block, _mm256_cmpgt_epi64(lo, block));
+        hi = _mm256_blendv_epi8(hi, block, _mm256_cmpgt_epi64(block, hi));
+    }
+    long long accParts[4], loParts[4], hiParts[4];
+    _mm256_storeu_si256((__m256i*)accParts, acc);
+    _mm256_storeu_si256((__m256i*)loParts, lo);
+    _mm256_storeu_si256((__m256i*)hiParts, hi);
+    sum = (accParts[0] + accParts[1]) + (accParts[2] + accParts[3]);
+    minValue = min(min(loParts[0], loParts[1]), min(loParts[2], loParts[3]));
+    maxValue = max(max(hiParts[0], hiParts[1]), max(hiParts[2], hiParts[3]));
+    for(; i < n; i++) {
+        sum += data[i];
+        minValue = min(minValue, data[i]);
+        maxValue = max(maxValue, data[i]);
+    }
+}
+
+#endif
+
+const ScanKernels SCALAR_KERNELS = {"Scalar", scalarFindInt32, scalarCountRangeInt32, scalarSumMinMaxInt64};
+#ifdef OSOMS_X86_SIMD
+const ScanKernels SSE_KERNELS = {"SSE4.1", sseFindInt32, sseCountRangeInt32, sseSumMinMaxInt64};
+const ScanKernels AVX2_KERNELS = {"AVX2", avx2FindInt32, avx2CountRangeInt32, avx2SumMinMaxInt64};
+#endif
+
+// Fills tiers with every kernel set this CPU can run, slowest first
+int availableScanKernels(const ScanKernels** tiers) {
+    int count = 0;
+    tiers[count++] = &SCALAR_KERNELS;
+#ifdef OSOMS_X86_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("sse4.1")) {
+        tiers[count++] = &SSE_KERNELS;
+    }
+    if(__builtin_cpu_supports("avx2")) {
+        tiers[count++] = &AVX2_KERNELS;
+    }
+#endif
+    return count;
+}
+
+// Picks the widest supported tier once; OSOMS_SIMD=scalar|sse4|avx2 caps it
+const ScanKernels& activeScanKernels() {
+    static const ScanKernels* active = nullptr;
+    if(active == nullptr) {
+        const ScanKernels* tiers[3];
+        int count = availableScanKernels(tiers);
+        int limit = count;
+        const char* cap = getenv("OSOMS_SIMD");
+        if(cap != nullptr) {
+            string capName = cap;
+            if(capName == "scalar") limit = 1;
+            else if(capName == "sse4") limit = min(count, 2);
+        }
+        active = tiers[limit - 1];
+    }
+    return *active;
+}
+
+// Finds orderID matches with the kernel, then confirms the customer name
+SearchResult columnSearch(const ScanKernels& kernels, int searchOrderID, const string& searchName) {
+    return columnSearchIn(getScanColumns(), kernels, searchOrderID, searchName);
+}
+
+// Same search over any column set (the whole list or one category partition)
+SearchResult columnSearchIn(const OrderColumns& cols, const ScanKernels& kernels, int searchOrderID, const string& searchName) {
+    const int* ids = cols.orderID.data();
+    int n = (int)cols.orderID.size();
+    
+    SearchResult result = {nullptr, -1};
+    int i = kernels.findInt32(ids, n, 0, searchOrderID);
+    while(i >= 0) {
+        if(cols.rows[i]->customerName == searchName) {
+            result.order = cols.rows[i];
+            result.position = i + 1;
+            break;
+        }
+        i = kernels.findInt32(ids, n, i + 1, searchOrderID);
+    }
+    return result;
+}
+
+void simdLinearSearch() {
+    clearScreen();
+    int searchOrderID;
+    string searchName;
+    const ScanKernels& kernels = activeScanKernels();
+    
+    cout << "\n============================================================\n";
+    cout << "                  SIMD LINEAR SEARCH                       \n";
+    cout << "============================================================\n";
+    cout << "  Kernel: " << kernels.name << "\n\n";
+    cout << "  Enter Order ID: ";
     cin >> searchOrderID;
     cin.ignore();
-    cout << "  Enter Customer Name: ";
-    getline(cin, searchName);
+    cout << "  Enter Customer Name: ";
+    getline(cin, searchName);
+    
+    auto bloomStart = high_resolution_clock::now();
+    if(!bloomMayContain(searchOrderID, searchName)) {
+        reportBloomReject(bloomStart);
+        return;
+    }
+    
+    getScanColumns();
+    
+    ScopedTimer timer(TIMER_SIMD_SEARCH);
+    SearchResult result = columnSearch(kernels, searchOrderID, searchName);
+    double executionTime = timer.stop();
+    countStat(STAT_COMPARISONS, result.order ? result.position : orderCount);
+    bloomRecordOutcome(result.order != nullptr);
+    
+    cout << "\n  ============================================================\n";
+    if(result.order != nullptr) {
+        cout << "  Status: FOUND\n";
+        cout << "  Position: " << result.position << "\n";
+        cout << "  ------------------------------------------------------------\n";
+        cout << "  Order ID: " << result.order->orderID << "\n";
+        cout << "  Customer: " << result.order->customerName << "\n";
+        cout << "  Phone: " << result.order->phoneNumber << "\n";
+        cout << "  Product: " << result.order->productName << "\n";
+        cout << "  Category: " << result.order->productCategory << "\n";
+        cout << "  Total Amount: RM " << formatMoney(result.order->totalAmount) << "\n";
+    } else {
+        cout << "  Status: NOT FOUND\n";
+    }
+    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+    cout << "  ============================================================\n";
+    pauseScreen();
+}
+
+// Sentinel search over a prepared array; tempArr[orderCount] is the sentinel slot
+int sentinelSearch(Order** tempArr, Order* sentinel, int searchOrderID, const string& searchName) {
+    sentinel->orderID = searchOrderID;
+    sentinel->customerName = searchName;
+    tempArr[orderCount] = sentinel;
+    
+    int i = 0;
+    while(!(tempArr[i]->orderID == searchOrderID && tempArr[i]->customerName == searchName)) {
+        i++;
+    }
+    return (i < orderCount) ? i : -1;
+}
+
+void performMultipleSearches() {
+    clearScreen();
+    const int SEARCH_COUNT = 100;
+    
+    cout << "\n============================================================\n";
+    cout << "              SEARCH BENCHMARK (100 SEARCHES)              \n";
+    cout << "============================================================\n";
+    cout << "  Preparing " << SEARCH_COUNT << " lookups (half hits, half misses)...\n";
+    
+    OrderColumns& cols = getScanColumns();
+    int n = (int)cols.rows.size();
+    
+    // Fixed seed so every run benchmarks the same lookups; a local engine
+    // leaves the global rand() sequence alone
+    mt19937 rng(2024);
+    vector<int> targetIDs(SEARCH_COUNT);
+    vector<string> targetNames(SEARCH_COUNT);
+    for(int k = 0; k < SEARCH_COUNT; k++) {
+        Order* pick = cols.rows[rng() % n];
+        targetIDs[k] = pick->orderID;
+        targetNames[k] = pick->customerName;
+        if(k % 2 == 1) {
+            targetNames[k] += " (mistyped)";
+        }
+    }
+    
+    Order** tempArr = new Order*[orderCount + 1];
+    for(int i = 0; i < orderCount; i++) {
+        tempArr[i] = cols.rows[i];
+    }
+    Order sentinel;
+    
+    int sentinelHits = 0;
+    auto start = high_resolution_clock::now();
+    for(int k = 0; k < SEARCH_COUNT; k++) {
+        if(sentinelSearch(tempArr, &sentinel, targetIDs[k], targetNames[k]) >= 0) {
+            sentinelHits++;
+        }
+    }
+    auto end = high_resolution_clock::now();
+    double sentinelTime = duration_cast<nanoseconds>(end - start).count() / 1000000.0;
+    delete[] tempArr;
+    
+    cout << "\n  +------------------------+-----------------+--------+----------+\n";
+    cout << "  | Method                 | Time (ms)       | Found  | Speedup  |\n";
+    cout << "  +------------------------+-----------------+--------+----------+\n";
+    cout << "  | " << setw(22) << left << "Sentinel (Order*)"
+         << " | " << setw(15) << right << fixed << setprecision(4) << sentinelTime
+         << " | " << setw(6) << sentinelHits
+         << " | " << setw(7) << setprecision(2) << 1.0 << "x |\n";
+    
+    const ScanKernels* tiers[3];
+    int tierCount = availableScanKernels(tiers);
+    for(int t = 0; t < tierCount; t++) {
+        int hits = 0;
+        start = high_resolution_clock::now();
+        for(int k = 0; k < SEARCH_COUNT; k++) {
+            if(columnSearch(*tiers[t], targetIDs[k], targetNames[k]).order != nullptr) {
+                hits++;
+            }
+        }
+        end = high_resolution_clock::now();
+        double tierTime = duration_cast<nanoseconds>(end - start).count() / 1000000.0;
+        string label = string(tiers[t]->name) + " column scan";
+        cout << "  | " << setw(22) << left << label
+             << " | " << setw(15) << right << fixed << setprecision(4) << tierTime
+             << " | " << setw(6) << hits
+             << " | " << setw(7) << setprecision(2) << (tierTime > 0 ? sentinelTime / tierTime : 0.0) << "x |\n";
+    }
+    
+    // Widest tier again, with the Bloom filter rejecting misses up front.
+    // Counters are saved and restored so the benchmark does not skew them.
+    BloomFilter savedCounters = orderBloom;
+    const ScanKernels& best = *tiers[tierCount - 1];
+    int bloomHits = 0;
+    start = high_resolution_clock::now();
+    for(int k = 0; k < SEARCH_COUNT; k++) {
+        if(bloomMayContain(targetIDs[k], targetNames[k]) &&
+           columnSearch(best, targetIDs[k], targetNames[k]).order != nullptr) {
+            bloomHits++;
+        }
+    }
+    end = high_resolution_clock::now();
+    double bloomTime = duration_cast<nanoseconds>(end - start).count() / 1000000.0;
+    orderBloom.probes = savedCounters.probes;
+    orderBloom.rejects = savedCounters.rejects;
+    orderBloom.passes = savedCounters.passes;
+    string bloomLabel = string("Bloom + ") + best.name;
+    cout << "  | " << setw(22) << left << bloomLabel
+         << " | " << setw(15) << right << fixed << setprecision(4) << bloomTime
+         << " | " << setw(6) << bloomHits
+         << " | " << setw(7) << setprecision(2) << (bloomTime > 0 ? sentinelTime / bloomTime : 0.0) << "x |\n";
+    cout << "  +------------------------+-----------------+--------+----------+\n";
+    
+    // Filter and aggregate kernels, each repeated to get a measurable time
+    const int KERNEL_REPEATS = 100;
+    cout << "\n  Kernel throughput (" << KERNEL_REPEATS << " passes over " << n << " rows)\n";
+    cout << "  +------------+---------------------+---------------------------+\n";
+    cout << "  | Kernel     | quantity >= 10 (ms) | sum/min/max amount (ms)   |\n";
+    cout << "  +------------+---------------------+---------------------------+\n";
+    for(int t = 0; t < tierCount; t++) {
+        volatile int matched = 0;
+        start = high_resolution_clock::now();
+        for(int r = 0; r < KERNEL_REPEATS; r++) {
+            matched = tiers[t]->countRangeInt32(cols.quantity.data(), n, 10, 2147483647);
+        }
+        end = high_resolution_clock::now();
+        double filterTime = duration_cast<nanoseconds>(end - start).count() / 1000000.0;
+        
+        volatile long long total = 0;
+        long long minValue, maxValue, sum;
+        start = high_resolution_clock::now();
+        for(int r = 0; r < KERNEL_REPEATS; r++) {
+            tiers[t]->sumMinMaxInt64(cols.totalAmount.data(), n, sum, minValue, maxValue);
+            total = sum;
+        }
+        end = high_resolution_clock::now();
+        double aggregateTime = duration_cast<nanoseconds>(end - start).count() / 1000000.0;
+        (void)matched;
+        (void)total;
+        
+        cout << "  | " << setw(10) << left << tiers[t]->name
+             << " | " << setw(19) << right << fixed << setprecision(4) << filterTime
+             << " | " << setw(25) << aggregateTime << " |\n";
+    }
+    cout << "  +------------+---------------------+---------------------------+\n";
+    cout << "  Active kernel for searches and reports: " << activeScanKernels().name << "\n";
+    
+    pauseScreen();
+}
+
+// ---------------------------------------------------------------------
+// Bloom filter
+// ---------------------------------------------------------------------
+
+uint64_t mixHash(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+uint64_t hashOrderKey(int orderID, const string& customerName) {
+    // FNV-1a over the name, seeded with the order ID
+    uint64_t h = 1469598103934665603ULL ^ (uint64_t)(uint32_t)orderID;
+    for(size_t i = 0; i < customerName.size(); i++) {
+        h ^= (unsigned char)customerName[i];
+        h *= 1099511628211ULL;
+    }
+    return mixHash(h);
+}
+
+// Sizes the filter for the current data and target FPR, then inserts every order
+void rebuildBloomFilter() {
+    BloomFilter& bloom = orderBloom;
+    size_t expected = max((size_t)orderCount, (size_t)1024);
+    double fpr = min(max(bloomTargetFpr, 0.0001), 0.5);
+    
+    double ln2 = log(2.0);
+    double bits = -(double)expected * log(fpr) / (ln2 * ln2);
+    bloom.blockCount = (size_t)ceil(bits / (64.0 * BLOOM_BLOCK_WORDS));
+    bloom.hashCount = (int)round(bits / expected * ln2);
+    bloom.hashCount = min(max(bloom.hashCount, 1), 16);
+    bloom.words.assign(bloom.blockCount * BLOOM_BLOCK_WORDS, 0);
+    bloom.capacity = expected;
+    bloom.itemCount = 0;
+    
+    for(Order* current = orderList; current != nullptr; current = current->next) {
+        bloomInsert(current->orderID, current->customerName);
+    }
+}
+
+// Sets the key's bits; the filter must already be sized
+void bloomInsert(int orderID, const string& customerName) {
+    BloomFilter& bloom = orderBloom;
+    uint64_t h = hashOrderKey(orderID, customerName);
+    uint64_t* block = &bloom.words[(h % bloom.blockCount) * BLOOM_BLOCK_WORDS];
+    uint32_t h1 = (uint32_t)(h >> 32);
+    uint32_t h2 = (uint32_t)h | 1;
+    for(int i = 0; i < bloom.hashCount; i++) {
+        uint32_t bit = (h1 + i * h2) & 511;
+        block[bit >> 6] |= 1ULL << (bit & 63);
+    }
+    bloom.itemCount++;
+}
+
+void bloomAdd(int orderID, const string& customerName) {
+    BloomFilter& bloom = orderBloom;
+    if(bloom.blockCount == 0 || bloom.itemCount >= bloom.capacity * 2) {
+        // Twice over capacity the real FPR is far above target; resize
+        rebuildBloomFilter();
+    }
+    // Inserted even after a rebuild: the order may not be linked into the
+    // list yet, and setting bits the rebuild already set is harmless
+    bloomInsert(orderID, customerName);
+}
+
+bool bloomMayContain(int orderID, const string& customerName) {
+    BloomFilter& bloom = orderBloom;
+    bloom.probes++;
+    if(bloom.blockCount == 0) {
+        bloom.passes++;
+        return true;
+    }
+    uint64_t h = hashOrderKey(orderID, customerName);
+    const uint64_t* block = &bloom.words[(h % bloom.blockCount) * BLOOM_BLOCK_WORDS];
+    uint32_t h1 = (uint32_t)(h >> 32);
+    uint32_t h2 = (uint32_t)h | 1;
+    for(int i = 0; i < bloom.hashCount; i++) {
+        uint32_t bit = (h1 + i * h2) & 511;
+        if((block[bit >> 6] & (1ULL << (bit & 63))) == 0) {
+            bloom.rejects++;
+            return false;
+        }
+    }
+    bloom.passes++;
+    return true;
+}
+
+// Called after a probe that passed the filter, once the scan has finished
+void bloomRecordOutcome(bool found) {
+    if(!found) {
+        orderBloom.falsePositives++;
+    }
+}
+
+void reportBloomReject(high_resolution_clock::time_point start) {
+    auto end = high_resolution_clock::now();
+    double executionTime = duration_cast<nanoseconds>(end - start).count() / 1000000.0;
+    
+    cout << "\n  ============================================================\n";
+    cout << "  Status: NOT FOUND\n";
+    cout << "  Rejected by Bloom filter (no scan needed)\n";
+    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+    cout << "  ============================================================\n";
+    pauseScreen();
+}
+
+void bloomFilterMenu() {
+    int choice;
+    do {
+        BloomFilter& bloom = orderBloom;
+        size_t bits = bloom.words.size() * 64;
+        double fill = 0;
+        for(size_t i = 0; i < bloom.words.size(); i++) {
+            fill += __builtin_popcountll(bloom.words[i]);
+        }
+        fill = bits > 0 ? fill / bits : 0;
+        double estimatedFpr = pow(fill, bloom.hashCount);
+        double observedFpr = (bloom.passes > 0) ? (double)bloom.falsePositives / bloom.passes : 0.0;
+        
+        clearScreen();
+        cout << "\n============================================================\n";
+        cout << "                BLOOM FILTER SETTINGS & STATS              \n";
+        cout << "============================================================\n";
+        cout << "  Target FPR:          " << fixed << setprecision(4) << bloomTargetFpr * 100 << " %\n";
+        cout << "  Estimated FPR:       " << estimatedFpr * 100 << " %\n";
+        cout << "  Items / Capacity:    " << bloom.itemCount << " / " << bloom.capacity << "\n";
+        cout << "  Size:                " << bloom.blockCount << " blocks, " << bits / 8 << " bytes\n";
+        cout << "  Hash Functions:      " << bloom.hashCount << "\n";
+        cout << "  Bits Set:            " << setprecision(2) << fill * 100 << " %\n";
+        cout << "------------------------------------------------------------\n";
+        cout << "  Probes:              " << bloom.probes << "\n";
+        cout << "  Rejected (absent):   " << bloom.rejects << "\n";
+        cout << "  Passed (maybe):      " << bloom.passes << "\n";
+        cout << "  False Positives:     " << bloom.falsePositives
+             << "  (" << setprecision(4) << observedFpr * 100 << " % of passes)\n";
+        cout << "============================================================\n";
+        cout << "  [1] Change Target False-Positive Rate\n";
+        cout << "  [2] Reset Counters\n";
+        cout << "  [0] Back to Searching Menu\n";
+        cout << "============================================================\n";
+        cout << "  Enter choice: ";
+        cin >> choice;
+        
+        switch(choice) {
+            case 1: {
+                double percent;
+                cout << "  Enter target FPR in percent (0.01 - 50): ";
+                if(cin >> percent && percent >= 0.01 && percent <= 50) {
+                    bloomTargetFpr = percent / 100.0;
+                    rebuildBloomFilter();
+                } else {
+                    cin.clear();
+                    cout << "\n  Invalid rate!\n";
+                    pauseScreen();
+                }
+                break;
+            }
+            case 2:
+                bloom.probes = bloom.rejects = bloom.passes = bloom.falsePositives = 0;
+                break;
+            case 0: break;
+            default: cout << "\n  Invalid choice!\n"; pauseScreen();
+        }
+    } while(choice != 0);
+}
+
+
+void calculateTotalSales() {
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "                 TOTAL SALES REPORT                        \n";
+    cout << "============================================================\n\n";
+    printPartialDataNote();
+    
+    ScopedTimer timer(TIMER_TOTAL_SALES);
+    OrderColumns& cols = getScanColumns();
+    int totalOrders = (int)cols.totalAmount.size();
+    const Money* amounts = cols.totalAmount.data();
+    const ScanKernels& kernels = activeScanKernels();
+    
+    // Each chunk is reduced by the SIMD kernel, chunks run on the pool.
+    // Cents add up exactly, so the total does not depend on the chunking.
+    struct SalesTotals {
+        Money sum, smallest, largest;
+        bool any;
+    };
+    SalesTotals none = {0, 0, 0, false};
+    SalesTotals totals = parallelReduce<SalesTotals>(0, totalOrders, PARALLEL_GRAIN, none,
+        [&](int first, int last) {
+            SalesTotals part;
+            kernels.sumMinMaxInt64(amounts + first, last - first, part.sum, part.smallest, part.largest);
+            part.any = true;
+            return part;
+        },
+        [](const SalesTotals& a, const SalesTotals& b) {
+            if(!a.any) return b;
+            if(!b.any) return a;
+            SalesTotals merged = {a.sum + b.sum, min(a.smallest, b.smallest), max(a.largest, b.largest), true};
+            return merged;
+        });
+    Money totalSales = totals.sum;
+    Money smallestOrder = totals.smallest;
+    Money largestOrder = totals.largest;
+    timer.stop();
+    
+    cout << "  +------------------------------------------------------------+\n";
+    cout << "  | Sales Summary                                              |\n";
+    cout << "  +------------------------------------------------------------+\n";
+    cout << "  | Total Orders:   " << setw(6) << totalOrders << " orders                             |\n";
+    cout << "  | Total Sales:    RM " << setw(18) << right << formatNumber(totalSales) << "                   |\n";
+    cout << "  | Largest Order:  RM " << setw(18) << right << formatNumber(largestOrder) << "                   |\n";
+    cout << "  | Smallest Order: RM " << setw(18) << right << formatNumber(smallestOrder) << "                   |\n";
+    cout << "  +------------------------------------------------------------+\n";
+    
+    pauseScreen();
+}
+
+void totalQuantitySold() {
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "          TOTAL QUANTITY SOLD (BY PRODUCT)                \n";
+    cout << "============================================================\n\n";
+    printPartialDataNote();
+    
+    struct ProductData {
+        string name;
+        int totalQuantity;
+    };
+    
+    ScopedTimer timer(TIMER_QUANTITY_REPORT);
+    ProductData products[50];
+    int productCount = 0;
+    
+    // Aggregate quantities by product
+    Order* current = orderList;
+    while(current != nullptr) {
+        bool found = false;
+        for(int i = 0; i < productCount; i++) {
+            if(products[i].name == current->productName) {
+                products[i].totalQuantity += current->quantity;
+                found = true;
+                break;
+            }
+        }
+        
+        if(!found && productCount < 50) {
+            products[productCount].name = current->productName;
+            products[productCount].totalQuantity = current->quantity;
+            productCount++;
+        }
+        current = current->next;
+    }
+    
+    // Sort by quantity (descending)
+    for(int i = 0; i < productCount - 1; i++) {
+        for(int j = 0; j < productCount - i - 1; j++) {
+            if(products[j].totalQuantity < products[j + 1].totalQuantity) {
+                ProductData temp = products[j];
+                products[j] = products[j + 1];
+                products[j + 1] = temp;
+            }
+        }
+    }
+    
+    timer.stop();
+    
+    cout << "  +----+-------------------------+------------------+\n";
+    cout << "  | No | Product Name            | Total Quantity   |\n";
+    cout << "  +----+-------------------------+------------------+\n";
+    
+    // Show highest selling product
+    if(productCount > 0) {
+        cout << "  | " << setw(2) << 1
+             << " | " << setw(23) << left << products[0].name.substr(0, 23)
+             << " | " << setw(16) << right << products[0].totalQuantity << " |\n";
+    }
+    
+    // Show lowest selling product
+    if(productCount > 1) {
+        cout << "  | " << setw(2) << productCount
+             << " | " << setw(23) << left << products[productCount - 1].name.substr(0, 23)
+             << " | " << setw(16) << right << products[productCount - 1].totalQuantity << " |\n";
+    }
+    
+    cout << "  +----+-------------------------+------------------+\n";
+    cout << "\n  Note: Showing highest and lowest selling products only.\n";
+    cout << "        Total products tracked: " << productCount << "\n";
+    
+    pauseScreen();
+}
+
+
+bool compareCategoryPartitions(const CategoryPartition* a, const CategoryPartition* b) {
+    if(a->columns.rows.size() != b->columns.rows.size()) {
+        return a->columns.rows.size() > b->columns.rows.size();
+    }
+    return a->name < b->name;
+}
+
+void salesByCategory() {
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "            SALES ANALYSIS BY CATEGORY                     \n";
+    cout << "============================================================\n\n";
+    printPartialDataNote();
+    
+    bool rebuilt = (categoryPartitions.builtVersion != layoutVersion);
+    CategoryPartitions& parts = getCategoryPartitions();
+    
+    // Aggregates are kept per partition; the report only ranks them
+    // by order count (descending - most orders first)
+    ScopedTimer timer(TIMER_CATEGORY_REPORT);
+    vector<const CategoryPartition*> ranked;
+    int totalOrders = 0;
+    Money grandTotal = 0;
+    for(size_t i = 0; i < parts.partitions.size(); i++) {
+        ranked.push_back(&parts.partitions[i]);
+        totalOrders += (int)parts.partitions[i].columns.rows.size();
+        grandTotal += parts.partitions[i].salesSum;
+    }
+    sort(ranked.begin(), ranked.end(), compareCategoryPartitions);
+    double executionTime = timer.stop();
+    
+    cout << "  +-----------------+------------+------------------+--------------+\n";
+    cout << "  | Category        | Orders     | Total Sales (RM) | Percentage % |\n";
+    cout << "  +-----------------+------------+------------------+--------------+\n";
+    
+    for(size_t i = 0; i < ranked.size(); i++) {
+        int categoryOrders = (int)ranked[i]->columns.rows.size();
+        double percentage = (totalOrders > 0) ? (categoryOrders * 100.0 / totalOrders) : 0.0;
+        cout << "  | " << setw(15) << left << ranked[i]->name.substr(0, 15)
+             << " | " << setw(10) << right << categoryOrders
+             << " | " << setw(16) << right << formatNumber(ranked[i]->salesSum)
+             << " | " << setw(12) << fixed << setprecision(2) << percentage << " |\n";
+    }
+    
+    cout << "  +-----------------+------------+------------------+--------------+\n";
+    cout << "  | TOTAL           | " << setw(10) << right << totalOrders 
+         << " | " << setw(16) << right << formatNumber(grandTotal) << " | " << setw(12) << "100.00" << " |\n";
+    cout << "  +-----------------+------------+------------------+--------------+\n";
+    if(rebuilt) {
+        cout << "  Partition Build Time: " << fixed << setprecision(4) << parts.buildTime << " ms\n";
+    }
+    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+    
+    pauseScreen();
+}
+
+void topCustomers() {
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "              TOP 10 CUSTOMERS BY SPENDING                 \n";
+    cout << "============================================================\n\n";
+    
+    struct CustomerSpending {
+        string customerName;
+        Money totalSpending;
+        int orderCount;
+    };
+    
+    CustomerSpending customers[2000];
+    int uniqueCustomers = 0;
+    
+    Order* current = orderList;
+    while(current != nullptr) {
+        bool found = false;
+        for(int i = 0; i < uniqueCustomers; i++) {
+            if(customers[i].customerName == current->customerName) {
+                customers[i].totalSpending += current->totalAmount;
+                customers[i].orderCount++;
+                found = true;
+                break;
+            }
+        }
+        
+        if(!found && uniqueCustomers < 2000) {
+            customers[uniqueCustomers].customerName = current->customerName;
+            customers[uniqueCustomers].totalSpending = current->totalAmount;
+            customers[uniqueCustomers].orderCount = 1;
+            uniqueCustomers++;
+        }
+        current = current->next;
+    }
+    
+    for(int i = 0; i < uniqueCustomers - 1; i++) {
+        for(int j = 0; j < uniqueCustomers - i - 1; j++) {
+            if(customers[j].totalSpending < customers[j + 1].totalSpending) {
+                CustomerSpending temp = customers[j];
+                customers[j] = customers[j + 1];
+                customers[j + 1] = temp;
+            }
+        }
+    }
+    
+    cout << "  +----+--------------------+--------+------------------+\n";
+    cout << "  | No | Customer Name      | Orders | Total Spent (RM) |\n";
+    cout << "  +----+--------------------+--------+------------------+\n";
+    
+    int displayCount = (uniqueCustomers < 10) ? uniqueCustomers : 10;
+    for(int i = 0; i < displayCount; i++) {
+        cout << "  | " << setw(2) << (i + 1)
+             << " | " << setw(18) << left << customers[i].customerName.substr(0, 18)
+             << " | " << setw(6) << right << customers[i].orderCount
+             << " | " << setw(16) << formatMoney(customers[i].totalSpending) << " |\n";
+    }
+    
+    cout << "  +----+--------------------+--------+------------------+\n";
+    
+    pauseScreen();
+}
+
+// ---------------------------------------------------------------------
+// Sketches
+// ---------------------------------------------------------------------
+
+uint64_t hashText(const string& text) {
+    return hashOrderKey(0, text);
+}
+
+// Standard error is 1.04 / sqrt(m) for m = 2^precision registers
+double hllStandardError(int precision) {
+    return 1.04 / sqrt(ldexp(1.0, precision));
+}
+
+// m = (1.04 / error)^2 registers, rounded up to a power of two; errors
+// below hllStandardError(HLL_MAX_PRECISION) are refused by the settings
+void initHyperLogLog(HyperLogLog& hll, double error) {
+    double registers = pow(1.04 / error, 2.0);
+    hll.precision = min(HLL_MAX_PRECISION, max(HLL_MIN_PRECISION, (int)ceil(log2(registers))));
+    hll.registers.assign((size_t)1 << hll.precision, 0);
+}
+
+void hllAdd(HyperLogLog& hll, uint64_t hash) {
+    size_t index = hash >> (64 - hll.precision);
+    uint64_t rest = hash << hll.precision;
+    int rank = rest ? __builtin_clzll(rest) + 1 : 64 - hll.precision + 1;
+    if(rank > hll.registers[index]) {
+        hll.registers[index] = (uint8_t)rank;
+    }
+}
+
+double hllEstimate(const HyperLogLog& hll) {
+    double m = (double)hll.registers.size();
+    double sum = 0;
+    int zeros = 0;
+    for(size_t i = 0; i < hll.registers.size(); i++) {
+        sum += ldexp(1.0, -hll.registers[i]);
+        zeros += (hll.registers[i] == 0);
+    }
+    double alpha = 0.7213 / (1 + 1.079 / m);
+    double estimate = alpha * m * m / sum;
+    if(estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * log(m / zeros);    // linear counting for small sets
+    }
+    return estimate;
+}
+
+// width = e / epsilon, depth = ln(1 / delta)
+void initCountMin(CountMinSketch& cms, double epsilon, double delta) {
+    cms.width = (size_t)ceil(exp(1.0) / max(epsilon, 0.00001));
+    cms.depth = max(1, (int)ceil(log(1.0 / min(max(delta, 0.0001), 0.5))));
+    cms.counts.assign(cms.width * cms.depth, 0);
+    cms.totalWeight = 0;
+}
+
+// Row r uses the hash h1 + r * h2 (Kirsch-Mitzenmacher)
+long long countMinAdd(CountMinSketch& cms, uint64_t hash, long long weight) {
+    uint64_t h1 = hash, h2 = mixHash(hash) | 1;
+    long long estimate = LLONG_MAX;
+    for(int r = 0; r < cms.depth; r++) {
+        long long& cell = cms.counts[r * cms.width + (h1 + r * h2) % cms.width];
+        cell += weight;
+        estimate = min(estimate, cell);
+    }
+    cms.totalWeight += weight;
+    return estimate;
+}
+
+bool heavierHitter(const pair<long long, string>& a, const pair<long long, string>& b) {
+    return a.first > b.first;   // min-heap on estimate
+}
+
+void heavyHittersOffer(HeavyHitters& top, const string& key, long long estimate) {
+    for(size_t i = 0; i < top.heap.size(); i++) {
+        if(top.heap[i].second == key) {
+            top.heap[i].first = estimate;
+            make_heap(top.heap.begin(), top.heap.end(), heavierHitter);
+            return;
+        }
+    }
+    if(top.heap.size() < top.k) {
+        top.heap.push_back(make_pair(estimate, key));
+        push_heap(top.heap.begin(), top.heap.end(), heavierHitter);
+    } else if(!top.heap.empty() && estimate > top.heap.front().first) {
+        pop_heap(top.heap.begin(), top.heap.end(), heavierHitter);
+        top.heap.back() = make_pair(estimate, key);
+        push_heap(top.heap.begin(), top.heap.end(), heavierHitter);
+    }
+}
+
+bool compareHitterEstimates(const pair<long long, string>& a, const pair<long long, string>& b) {
+    if(a.first != b.first) {
+        return a.first > b.first;
+    }
+    return a.second < b.second;
+}
+
+// Heavy hitters in descending order of estimate
+vector<pair<long long, string> > heavyHittersRanked(const HeavyHitters& top) {
+    vector<pair<long long, string> > ranked = top.heap;
+    sort(ranked.begin(), ranked.end(), compareHitterEstimates);
+    return ranked;
+}
+
+void initSketches(OrderSketches& sketches, const SketchSettings& settings) {
+    initHyperLogLog(sketches.customers, settings.distinctError);
+    initHyperLogLog(sketches.products, settings.distinctError);
+    initHyperLogLog(sketches.phones, settings.distinctError);
+    initCountMin(sketches.productQuantity, settings.countEpsilon, settings.countDelta);
+    initCountMin(sketches.customerSpending, settings.countEpsilon, settings.countDelta);
+    sketches.topProducts.heap.clear();
+    sketches.topProducts.k = settings.topK;
+    sketches.topCustomers.heap.clear();
+    sketches.topCustomers.k = settings.topK;
+    sketches.sample.capacity = settings.reservoirSize;
+    sketches.sample.amounts.clear();
+    sketches.sample.quantities.clear();
+    sketches.sample.seen = 0;
+    sketches.sample.random.seed(20240101);
+}
+
+// Feeds one order to every sketch; nothing here grows with the stream
+void sketchOrder(OrderSketches& sketches, const Order* order) {
+    uint64_t customerHash = hashText(order->customerName);
+    uint64_t productHash = hashText(order->productName);
+    hllAdd(sketches.customers, customerHash);
+    hllAdd(sketches.products, productHash);
+    hllAdd(sketches.phones, hashText(order->phoneNumber));
+    
+    heavyHittersOffer(sketches.topProducts, order->productName,
+                      countMinAdd(sketches.productQuantity, productHash, order->quantity));
+    heavyHittersOffer(sketches.topCustomers, order->customerName,
+                      countMinAdd(sketches.customerSpending, customerHash, order->totalAmount));
+    
+    // Reservoir sampling (algorithm R)
+    OrderReservoir& sample = sketches.sample;
+    sample.seen++;
+    if(sample.amounts.size() < sample.capacity) {
+        sample.amounts.push_back(order->totalAmount);
+        sample.quantities.push_back(order->quantity);
+    } else {
+        unsigned long long slot = sample.random() % (unsigned long long)sample.seen;
+        if(slot < sample.capacity) {
+            sample.amounts[slot] = order->totalAmount;
+            sample.quantities[slot] = order->quantity;
+        }
+    }
+}
+
+size_t sketchMemoryBytes(const OrderSketches& sketches) {
+    size_t bytes = sketches.customers.registers.size() + sketches.products.registers.size()
+                 + sketches.phones.registers.size();
+    bytes += (sketches.productQuantity.counts.size() + sketches.customerSpending.counts.size()) * sizeof(long long);
+    const HeavyHitters* tops[2] = {&sketches.topProducts, &sketches.topCustomers};
+    for(int t = 0; t < 2; t++) {
+        bytes += tops[t]->heap.capacity() * sizeof(pair<long long, string>);
+        for(size_t i = 0; i < tops[t]->heap.size(); i++) {
+            bytes += tops[t]->heap[i].second.capacity();
+        }
+    }
+    bytes += sketches.sample.amounts.capacity() * sizeof(Money)
+           + sketches.sample.quantities.capacity() * sizeof(int);
+    return bytes;
+}
+
+// Exact totals per key by sorting the keys, for comparison with the sketches
+vector<pair<long long, string> > exactTotals(vector<pair<string, long long> >& rows) {
+    sort(rows.begin(), rows.end());
+    vector<pair<long long, string> > totals;
+    for(size_t i = 0; i < rows.size(); i++) {
+        if(totals.empty() || totals.back().second != rows[i].first) {
+            totals.push_back(make_pair(0LL, rows[i].first));
+        }
+        totals.back().first += rows[i].second;
+    }
+    sort(totals.begin(), totals.end(), compareHitterEstimates);
+    return totals;
+}
+
+long long exactTotalFor(const vector<pair<long long, string> >& totals, const string& key) {
+    for(size_t i = 0; i < totals.size(); i++) {
+        if(totals[i].second == key) {
+            return totals[i].first;
+        }
+    }
+    return 0;
+}
+
+void printTopComparison(const char* title, const vector<pair<long long, string> >& estimated,
+                        const vector<pair<long long, string> >& exact, bool money) {
+    cout << "\n  " << title << "\n";
+    cout << "  +----+----------------------+------------------+------------------+------------+\n";
+    cout << "  | No | Sketch Top           | Estimate         | Exact            | Exact Rank |\n";
+    cout << "  +----+----------------------+------------------+------------------+------------+\n";
+    for(size_t i = 0; i < estimated.size(); i++) {
+        long long exactValue = exactTotalFor(exact, estimated[i].second);
+        size_t rank = 0;
+        while(rank < exact.size() && exact[rank].second != estimated[i].second) {
+            rank++;
+        }
+        cout << "  | " << setw(2) << right << (i + 1)
+             << " | " << setw(20) << left << estimated[i].second.substr(0, 20)
+             << " | " << setw(16) << right << (money ? formatNumber(estimated[i].first) : to_string(estimated[i].first))
+             << " | " << setw(16) << (money ? formatNumber(exactValue) : to_string(exactValue))
+             << " | " << setw(10) << (rank + 1) << " |\n";
+    }
+    cout << "  +----+----------------------+------------------+------------------+------------+\n";
+}
+
+// Reads the next order line from the file into order, skipping blank
+// and malformed lines. Returns false at the end of the file.
+bool readNextOrder(istream& input, string& line, Order& order, long long& malformed) {
+    while(getline(input, line)) {
+        if(!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);
+        }
+        if(line.empty()) {
+            continue;
+        }
+        if(parseOrderLine(line, &order)) {
+            return true;
+        }
+        malformed++;
+    }
+    return false;
+}
+
+// Streams the file through the sketches one line at a time; only the
+// exact comparison keeps every key
+void approximateAnalyticsReport(const string& path) {
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "            APPROXIMATE ANALYTICS (SKETCHES)               \n";
+    cout << "============================================================\n";
+    ifstream input(path.c_str());
+    if(!input) {
+        cout << "  Error: cannot open " << path << "\n";
+        pauseScreen();
+        return;
+    }
+    
+    // One streaming pass feeds every sketch
+    OrderSketches sketches;
+    initSketches(sketches, sketchSettings);
+    string line;
+    Order order;
+    long long malformed = 0;
+    ScopedTimer timer(TIMER_SKETCH_BUILD);
+    while(readNextOrder(input, line, order, malformed)) {
+        sketchOrder(sketches, &order);
+    }
+    double sketchTime = timer.stop();
+    
+    // Exact answers the slow way round, for comparison
+    input.clear();
+    input.seekg(0);
+    auto start = high_resolution_clock::now();
+    vector<string> customers, products, phones;
+    vector<pair<string, long long> > productRows, customerRows;
+    Money amountSum = 0;
+    long long quantitySum = 0;
+    long long ignored = 0;
+    while(readNextOrder(input, line, order, ignored)) {
+        customers.push_back(order.customerName);
+        products.push_back(order.productName);
+        phones.push_back(order.phoneNumber);
+        productRows.push_back(make_pair(order.productName, (long long)order.quantity));
+        customerRows.push_back(make_pair(order.customerName, order.totalAmount));
+        amountSum += order.totalAmount;
+        quantitySum += order.quantity;
+    }
+    vector<string>* columns[3] = {&customers, &products, &phones};
+    size_t exactDistinct[3];
+    for(int c = 0; c < 3; c++) {
+        sort(columns[c]->begin(), columns[c]->end());
+        exactDistinct[c] = unique(columns[c]->begin(), columns[c]->end()) - columns[c]->begin();
+    }
+    vector<pair<long long, string> > exactProducts = exactTotals(productRows);
+    vector<pair<long long, string> > exactCustomers = exactTotals(customerRows);
+    double exactTime = duration_cast<microseconds>(high_resolution_clock::now() - start).count() / 1000.0;
+    
+    const SketchSettings& settings = sketchSettings;
+    cout << "  Orders Streamed: " << sketches.sample.seen << " from " << path;
+    if(malformed > 0) {
+        cout << " (" << malformed << " malformed lines skipped)";
+    }
+    cout << "\n";
+    cout << "  HyperLogLog: 2^" << sketches.customers.precision << " registers (std. error "
+         << fixed << setprecision(2) << hllStandardError(sketches.customers.precision) * 100 << "%)\n";
+    cout << "  Count-Min: " << sketches.productQuantity.width << " x " << sketches.productQuantity.depth
+         << " (overestimate <= " << setprecision(3) << settings.countEpsilon * 100 << "% of total, "
+         << setprecision(1) << (1 - settings.countDelta) * 100 << "% of the time)\n";
+    cout << "  Sketch Memory: " << sketchMemoryBytes(sketches) << " bytes\n";
+    cout << "  Sketch Pass: " << fixed << setprecision(4) << sketchTime << " ms  |  Exact Pass: "
+         << exactTime << " ms\n";
+    
+    const char* names[3] = {"Customers", "Products", "Phone Numbers"};
+    const HyperLogLog* sketchesByField[3] = {&sketches.customers, &sketches.products, &sketches.phones};
+    cout << "\n  Distinct counts\n";
+    cout << "  +-----------------+--------------+--------------+----------+\n";
+    cout << "  | Field           | Estimate     | Exact        | Error %  |\n";
+    cout << "  +-----------------+--------------+--------------+----------+\n";
+    for(int c = 0; c < 3; c++) {
+        double estimate = hllEstimate(*sketchesByField[c]);
+        double error = exactDistinct[c] ? (estimate - exactDistinct[c]) * 100.0 / exactDistinct[c] : 0.0;
+        cout << "  | " << setw(15) << left << names[c]
+             << " | " << setw(12) << right << setprecision(0) << estimate
+             << " | " << setw(12) << exactDistinct[c]
+             << " | " << setw(8) << setprecision(2) << error << " |\n";
+    }
+    cout << "  +-----------------+--------------+--------------+----------+\n";
+    
+    printTopComparison("Top products by quantity (Count-Min + heap)",
+                       heavyHittersRanked(sketches.topProducts), exactProducts, false);
+    printTopComparison("Top customers by spending, RM (Count-Min + heap)",
+                       heavyHittersRanked(sketches.topCustomers), exactCustomers, true);
+    
+    const OrderReservoir& sample = sketches.sample;
+    Money sampleAmount = 0;
+    long long sampleQuantity = 0;
+    for(size_t i = 0; i < sample.amounts.size(); i++) {
+        sampleAmount += sample.amounts[i];
+        sampleQuantity += sample.quantities[i];
+    }
+    size_t sampled = max(sample.amounts.size(), (size_t)1);
+    long long rows = max(sample.seen, 1LL);
+    cout << "\n  Averages from a " << sample.amounts.size() << "-order reservoir sample\n";
+    cout << "    Order Amount: RM " << formatNumber(sampleAmount / (Money)sampled)
+         << " (exact RM " << formatNumber(amountSum / rows) << ")\n";
+    cout << "    Quantity: " << fixed << setprecision(2) << (double)sampleQuantity / sampled
+         << " (exact " << (double)quantitySum / rows << ")\n";
+    pauseScreen();
+}
+
+void configureSketches() {
+    SketchSettings& settings = sketchSettings;
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "                  SKETCH ERROR BOUNDS                      \n";
+    cout << "============================================================\n";
+    cout << "  Current: distinct error " << fixed << setprecision(2) << settings.distinctError * 100
+         << "%, Count-Min epsilon " << setprecision(3) << settings.countEpsilon * 100
+         << "%, delta " << setprecision(2) << settings.countDelta * 100
+         << "%, top " << settings.topK << ", reservoir " << settings.reservoirSize << "\n\n";
+    
+    SketchSettings updated;
+    double minDistinctError = ceil(hllStandardError(HLL_MAX_PRECISION) * 100000) / 1000;    // %, to 3 places
+    cout << "  Distinct count error % (e.g. 1, at least " << setprecision(3) << minDistinctError << "): ";
+    cin >> updated.distinctError;
+    cout << "  Count-Min epsilon % of total (e.g. 0.05): ";
+    cin >> updated.countEpsilon;
+    cout << "  Count-Min failure probability % (e.g. 1): ";
+    cin >> updated.countDelta;
+    cout << "  Heavy hitters to keep (e.g. 10): ";
+    cin >> updated.topK;
+    cout << "  Reservoir size (e.g. 4096): ";
+    cin >> updated.reservoirSize;
+    if(!cin || updated.distinctError <= 0 || updated.countEpsilon <= 0 || updated.countDelta <= 0
+       || updated.countDelta >= 100 || updated.topK < 1 || updated.reservoirSize < 1) {
+        cin.clear();
+        cout << "\n  Invalid settings, nothing changed!\n";
+        pauseScreen();
+        return;
+    }
+    if(updated.distinctError < minDistinctError) {
+        cout << "\n  Distinct count error below " << setprecision(3) << minDistinctError
+             << "% needs more than 2^" << HLL_MAX_PRECISION << " registers, nothing changed!\n";
+        pauseScreen();
+        return;
+    }
+    updated.distinctError /= 100;
+    updated.countEpsilon /= 100;
+    updated.countDelta /= 100;
+    settings = updated;
+    
+    OrderSketches sizing;
+    initSketches(sizing, settings);
+    cout << "\n  HyperLogLog: 2^" << sizing.customers.precision << " registers, std. error "
+         << setprecision(2) << hllStandardError(sizing.customers.precision) * 100 << "%\n";
+    cout << "  Sketch memory will be " << sketchMemoryBytes(sizing) << " bytes\n";
+    pauseScreen();
+}
+
+void approximateAnalyticsMenu() {
+    int choice;
+    string path;
+    do {
+        clearScreen();
+        cout << "\n============================================================\n";
+        cout << "            APPROXIMATE ANALYTICS (SKETCHES)               \n";
+        cout << "============================================================\n";
+        cout << "  [1] Run Sketch Report on orders_data.txt (vs Exact)\n";
+        cout << "  [2] Run Sketch Report on Another File\n";
+        cout << "  [3] Configure Error Bounds\n";
+        cout << "  [0] Back to Reports Menu\n";
+        cout << "============================================================\n";
+        cout << "  Enter choice: ";
+        cin >> choice;
+        
+        switch(choice) {
+            case 1: approximateAnalyticsReport("orders_data.txt"); break;
+            case 2:
+                cout << "  Input file: ";
+                cin >> path;
+                approximateAnalyticsReport(path);
+                break;
+            case 3: configureSketches(); break;
+            case 0: break;
+            default: cout << "\n  Invalid choice!\n"; pauseScreen();
+        }
+    } while(choice != 0);
+}
+
+// ---------------------------------------------------------------------
+// Query engine
+// ---------------------------------------------------------------------
+
+int compareIgnoreCase(const string& a, const string& b) {
+    size_t n = min(a.size(), b.size());
+    for(size_t i = 0; i < n; i++) {
+        int ca = tolower((unsigned char)a[i]);
+        int cb = tolower((unsigned char)b[i]);
+        if(ca != cb) {
+            return ca < cb ? -1 : 1;
+        }
+    }
+    return (a.size() == b.size()) ? 0 : (a.size() < b.size() ? -1 : 1);
+}
+
+bool isStringColumn(QueryColumn column) {
+    return column >= QUERY_CUSTOMER && column <= QUERY_CATEGORY;
+}
+
+bool isMoneyColumn(QueryColumn column) {
+    return column == QUERY_UNIT_PRICE || column == QUERY_TOTAL_AMOUNT;
+}
+
+void appendToDictionary(DictionaryColumn& dict, const string& text) {
+    unordered_map<string, int>::iterator found = dict.lookup.find(text);
+    int code;
+    if(found == dict.lookup.end()) {
+        code = (int)dict.values.size();
+        dict.lookup[text] = code;
+        dict.values.push_back(text);
+        dict.counts.push_back(0);
+    } else {
+        code = found->second;
+    }
+    dict.codes.push_back(code);
+    dict.counts[code]++;
+}
+
+// Returns the dictionary for a string column, rebuilding it if the list
+// has changed; codes line up with the rows of getScanColumns()
+DictionaryColumn& getQueryDictionary(QueryColumn column) {
+    DictionaryColumn& dict = queryDictionaries[column - QUERY_CUSTOMER];
+    if(dict.builtVersion == layoutVersion) {
+        return dict;
+    }
+    OrderColumns& cols = getScanColumns();
+    string Order::* field = QUERY_STRING_FIELDS[column - QUERY_CUSTOMER];
+    
+    dict.codes.clear();
+    dict.values.clear();
+    dict.counts.clear();
+    dict.lookup.clear();
+    dict.codes.reserve(cols.rows.size());
+    for(size_t r = 0; r < cols.rows.size(); r++) {
+        appendToDictionary(dict, cols.rows[r]->*field);
+    }
+    dict.builtVersion = layoutVersion;
+    return dict;
+}
+
+// Filter tests for filterBatch
+struct RangeTest {
+    long long lo;
+    long long hi;
+    bool operator()(long long value) const { return value >= lo && value <= hi; }
+};
+
+struct NotEqualTest {
+    long long value;
+    bool operator()(long long v) const { return v != value; }
+};
+
+struct CodeTest {
+    const char* matches;
+    bool operator()(int code) const { return matches[code] != 0; }
+};
+
+// Every row is written to out and the count only advances past rows that
+// pass, so the loop has no data-dependent branch. out may alias in.
+template <typename T, typename Test>
+int filterBatch(const T* data, const Test& test, const int* in, int count, int begin, int* out) {
+    int kept = 0;
+    if(in == nullptr) {
+        for(int s = 0; s < count; s++) {
+            out[kept] = begin + s;
+            kept += test(data[begin + s]);
+        }
+    } else {
+        for(int s = 0; s < count; s++) {
+            int row = in[s];
+            out[kept] = row;
+            kept += test(data[row]);
+        }
+    }
+    return kept;
+}
+
+int intRangeKernel(const CompiledFilter& filter, const int* in, int count, int begin, int* out) {
+    RangeTest test = {filter.lo, filter.hi};
+    return filterBatch(filter.intData, test, in, count, begin, out);
+}
+
+int moneyRangeKernel(const CompiledFilter& filter, const int* in, int count, int begin, int* out) {
+    RangeTest test = {filter.lo, filter.hi};
+    return filterBatch(filter.moneyData, test, in, count, begin, out);
+}
+
+int intNotEqualKernel(const CompiledFilter& filter, const int* in, int count, int begin, int* out) {
+    NotEqualTest test = {filter.lo};
+    return filterBatch(filter.intData, test, in, count, begin, out);
+}
+
+int moneyNotEqualKernel(const CompiledFilter& filter, const int* in, int count, int begin, int* out) {
+    NotEqualTest test = {filter.lo};
+    return filterBatch(filter.moneyData, test, in, count, begin, out);
+}
+
+int codeKernel(const CompiledFilter& filter, const int* in, int count, int begin, int* out) {
+    CodeTest test = {&filter.codeMatches[0]};
+    return filterBatch(filter.intData, test, in, count, begin, out);
+}
+
+// Copies the selected rows of a numeric column into out
+void gatherQueryColumn(const OrderColumns& cols, QueryColumn column, const int* selection, int count, long long* out) {
+    switch(column) {
+        case QUERY_ORDER_ID: {
+            const int* data = cols.orderID.data();
+            for(int s = 0; s < count; s++) out[s] = data[selection[s]];
+            break;
+        }
+        case QUERY_QUANTITY: {
+            const int* data = cols.quantity.data();
+            for(int s = 0; s < count; s++) out[s] = data[selection[s]];
+            break;
+        }
+        case QUERY_UNIT_PRICE: {
+            const Money* data = cols.unitPrice.data();
+            for(int s = 0; s < count; s++) out[s] = data[selection[s]];
+            break;
+        }
+        default: {
+            const Money* data = cols.totalAmount.data();
+            for(int s = 0; s < count; s++) out[s] = data[selection[s]];
+            break;
+        }
+    }
+}
+
+struct QueryToken {
+    string text;
+    bool quoted;
+};
+
+// Splits on whitespace, keeping quoted text and runs of = ! < > as single
+// tokens; parentheses and commas only separate
+vector<QueryToken> tokenizeQuery(const string& text) {
+    vector<QueryToken> tokens;
+    size_t i = 0;
+    while(i < text.size()) {
+        char c = text[i];
+        if(isspace((unsigned char)c) || c == '(' || c == ')' || c == ',') {
+            i++;
+        } else if(c == '"' || c == '\'') {
+            size_t close = text.find(c, i + 1);
+            if(close == string::npos) {
+                throw invalid_argument("unterminated quote");
+            }
+            QueryToken token = {text.substr(i + 1, close - i - 1), true};
+            tokens.push_back(token);
+            i = close + 1;
+        } else {
+            bool isOperator = strchr("=!<>", c) != nullptr;
+            size_t start = i;
+            while(i < text.size()) {
+                char d = text[i];
+                bool operatorChar = strchr("=!<>", d) != nullptr;
+                if(operatorChar != isOperator || isspace((unsigned char)d) ||
+                   d == '(' || d == ')' || d == ',' || d == '"' || d == '\'') {
+                    break;
+                }
+                i++;
+            }
+            QueryToken token = {text.substr(start, i - start), false};
+            tokens.push_back(token);
+        }
+    }
+    return tokens;
+}
+
+bool isQueryKeyword(const QueryToken& token, const char* keyword) {
+    return !token.quoted && compareIgnoreCase(token.text, keyword) == 0;
+}
+
+// Keywords that end a filter value written without quotes
+bool endsQueryValue(const QueryToken& token) {
+    const char* keywords[] = {"AND", "GROUP", "COUNT", "SUM", "AVG", "MIN", "MAX", "LIMIT"};
+    for(int k = 0; k < 8; k++) {
+        if(isQueryKeyword(token, keywords[k])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+QueryColumn parseQueryColumn(const QueryToken& token) {
+    struct ColumnAlias {
+        const char* name;
+        QueryColumn column;
+    };
+    const ColumnAlias aliases[] = {
+        {"id", QUERY_ORDER_ID}, {"customer", QUERY_CUSTOMER}, {"phone", QUERY_PHONE},
+        {"product", QUERY_PRODUCT}, {"productCategory", QUERY_CATEGORY}, {"qty", QUERY_QUANTITY},
+        {"price", QUERY_UNIT_PRICE}, {"amount", QUERY_TOTAL_AMOUNT}, {"total", QUERY_TOTAL_AMOUNT}
+    };
+    for(int c = 0; c < QUERY_COLUMN_COUNT; c++) {
+        if(compareIgnoreCase(token.text, QUERY_COLUMN_NAMES[c]) == 0) {
+            return (QueryColumn)c;
+        }
+    }
+    for(size_t a = 0; a < sizeof(aliases) / sizeof(aliases[0]); a++) {
+        if(compareIgnoreCase(token.text, aliases[a].name) == 0) {
+            return aliases[a].column;
+        }
+    }
+    throw invalid_argument("unknown column '" + token.text + "'");
+}
+
+long long parseQueryValue(QueryColumn column, const string& text) {
+    if(isMoneyColumn(column)) {
+        try {
+            return parseMoney(text);
+        } catch(const logic_error&) {
+            throw invalid_argument("'" + text + "' is not an amount");
+        }
+    }
+    char* end = nullptr;
+    errno = 0;
+    long long value = strtoll(text.c_str(), &end, 10);
+    if(text.empty() || *end != '\0' || errno == ERANGE) {
+        throw invalid_argument("'" + text + "' is not a whole number");
+    }
+    return value;
+}
+
+string formatQueryKey(QueryColumn column, long long value) {
+    if(isMoneyColumn(column)) {
+        return formatMoney(value);
+    }
+    return to_string(value);
+}
+
+string describeFilter(const CompiledFilter& filter) {
+    string name = QUERY_COLUMN_NAMES[filter.column];
+    if(filter.kind == FILTER_NOT_EQUAL) {
+        return name + " != " + formatQueryKey(filter.column, filter.lo);
+    }
+    if(filter.kind == FILTER_RANGE) {
+        string lo = (filter.lo == LLONG_MIN) ? "min" : formatQueryKey(filter.column, filter.lo);
+        string hi = (filter.hi == LLONG_MAX) ? "max" : formatQueryKey(filter.column, filter.hi);
+        return name + " in [" + lo + ", " + hi + "]";
+    }
+    const DictionaryColumn& dict = queryDictionaries[filter.column - QUERY_CUSTOMER];
+    int matching = 0;
+    string first;
+    for(size_t code = 0; code < filter.codeMatches.size(); code++) {
+        if(filter.codeMatches[code]) {
+            if(matching == 0) {
+                first = dict.values[code];
+            }
+            matching++;
+        }
+    }
+    string text = name + " code in {";
+    text += (matching == 1) ? "\"" + first + "\"" : to_string(matching) + " values";
+    return text + "} of " + to_string(filter.codeMatches.size());
+}
+
+// Fraction of rows a numeric filter keeps: exact from the range index when
+// it is current, a fixed guess otherwise
+double estimateRangeFilter(const CompiledFilter& filter) {
+    int index = -1;
+    if(filter.column == QUERY_QUANTITY) index = RANGE_QUANTITY;
+    if(filter.column == QUERY_UNIT_PRICE) index = RANGE_UNIT_PRICE;
+    if(filter.column == QUERY_TOTAL_AMOUNT) index = RANGE_TOTAL_AMOUNT;
+    if(index >= 0 && rangeIndexes[index].builtVersion == dataVersion
+       && !getRangeIndex((RangeColumn)index).keys.empty()) {
+        const RangeIndex& range = rangeIndexes[index];
+        size_t first, last;
+        if(filter.kind == FILTER_RANGE) {
+            findRangeBounds(range, filter.lo, filter.hi, first, last);
+            return (double)(last - first) / range.keys.size();
+        }
+        findRangeBounds(range, filter.lo, filter.lo, first, last);
+        return 1.0 - (double)(last - first) / range.keys.size();
+    }
+    if(filter.kind == FILTER_NOT_EQUAL) {
+        return 0.9;
+    }
+    return (filter.lo == filter.hi) ? 0.1 : 0.5;
+}
+
+// Fetches a dictionary while compiling, noting in the plan when it had to
+// be built (the first query on a column after a load or a sort)
+DictionaryColumn& compileDictionary(CompiledQuery& query, QueryColumn column) {
+    bool current = queryDictionaries[column - QUERY_CUSTOMER].builtVersion == layoutVersion;
+    DictionaryColumn& dict = getQueryDictionary(column);
+    if(!current) {
+        query.notes.push_back(string("built dictionary for ") + QUERY_COLUMN_NAMES[column] + " (" +
+                              to_string(dict.values.size()) + " values)");
+    }
+    return dict;
+}
+
+// Parses and compiles a query; throws invalid_argument on a syntax error
+//   [WHERE] column op value [AND ...] [GROUP BY column]
+//   [COUNT | SUM|AVG|MIN|MAX column ...] [LIMIT n]
+CompiledQuery compileQuery(const string& text) {
+    auto start = high_resolution_clock::now();
+    vector<QueryToken> tokens = tokenizeQuery(text);
+    OrderColumns& cols = getScanColumns();
+    
+    CompiledQuery query;
+    query.neverMatches = false;
+    query.grouped = false;
+    query.groupBy = QUERY_CATEGORY;
+    query.limit = QUERY_DISPLAY_LIMIT;
+    
+    size_t t = 0;
+    if(t < tokens.size() && isQueryKeyword(tokens[t], "WHERE")) {
+        t++;
+    }
+    
+    // Filters; several on one column are merged into one
+    while(t < tokens.size() && !endsQueryValue(tokens[t])) {
+        QueryColumn column = parseQueryColumn(tokens[t++]);
+        if(t >= tokens.size() || tokens[t].quoted || !strchr("=!<>", tokens[t].text[0])) {
+            throw invalid_argument(string("expected an operator after ") + QUERY_COLUMN_NAMES[column]);
+        }
+        string op = tokens[t++].text;
+        if(op != "=" && op != "!=" && op != "<" && op != "<=" && op != ">" && op != ">=") {
+            throw invalid_argument("unknown operator '" + op + "'");
+        }
+        string value;
+        if(t < tokens.size() && tokens[t].quoted) {
+            value = tokens[t++].text;
+        } else {
+            while(t < tokens.size() && !endsQueryValue(tokens[t])) {
+                value += (value.empty() ? "" : " ") + tokens[t++].text;
+            }
+        }
+        if(value.empty() && (t == 0 || !tokens[t - 1].quoted)) {
+            throw invalid_argument(string("missing value for ") + QUERY_COLUMN_NAMES[column]);
+        }
+        
+        CompiledFilter* filter = nullptr;
+        for(size_t f = 0; f < query.filters.size(); f++) {
+            if(query.filters[f].column == column && query.filters[f].kind != FILTER_NOT_EQUAL) {
+                filter = &query.filters[f];
+            }
+        }
+        
+        if(isStringColumn(column)) {
+            DictionaryColumn& dict = compileDictionary(query, column);
+            if(filter == nullptr) {
+                query.filters.push_back(CompiledFilter());
+                filter = &query.filters.back();
+                filter->column = column;
+                filter->kind = FILTER_CODES;
+                filter->codeMatches.assign(dict.values.size(), 1);
+                filter->intData = dict.codes.data();
+                filter->moneyData = nullptr;
+                filter->kernel = codeKernel;
+            }
+            for(size_t code = 0; code < dict.values.size(); code++) {
+                int cmp = compareIgnoreCase(dict.values[code], value);
+                bool match = (op == "=") ? cmp == 0 : (op == "!=") ? cmp != 0 :
+                             (op == "<") ? cmp < 0 : (op == "<=") ? cmp <= 0 :
+                             (op == ">") ? cmp > 0 : cmp >= 0;
+                filter->codeMatches[code] &= match;
+            }
+        } else {
+            long long v = parseQueryValue(column, value);
+            if(op == "!=") {
+                filter = nullptr;
+            }
+            if(filter == nullptr) {
+                query.filters.push_back(CompiledFilter());
+                filter = &query.filters.back();
+                filter->column = column;
+                filter->kind = (op == "!=") ? FILTER_NOT_EQUAL : FILTER_RANGE;
+                filter->lo = (op == "!=") ? v : LLONG_MIN;
+                filter->hi = LLONG_MAX;
+                filter->intData = (column == QUERY_ORDER_ID) ? cols.orderID.data() : cols.quantity.data();
+                filter->moneyData = (column == QUERY_UNIT_PRICE) ? cols.unitPrice.data() : cols.totalAmount.data();
+                if(isMoneyColumn(column)) {
+                    filter->kernel = (op == "!=") ? moneyNotEqualKernel : moneyRangeKernel;
+                } else {
+                    filter->kernel = (op == "!=") ? intNotEqualKernel : intRangeKernel;
+                }
+            }
+            if(op == "=" || op == ">=") filter->lo = max(filter->lo, v);
+            if(op == "=" || op == "<=") filter->hi = min(filter->hi, v);
+            if(op == ">") filter->lo = max(filter->lo, v == LLONG_MAX ? v : v + 1);
+            if(op == "<") filter->hi = min(filter->hi, v == LLONG_MIN ? v : v - 1);
+            if(op == ">" && v == LLONG_MAX) query.neverMatches = true;
+            if(op == "<" && v == LLONG_MIN) query.neverMatches = true;
+        }
+        
+        if(t < tokens.size() && !endsQueryValue(tokens[t])) {
+            throw invalid_argument("expected AND, GROUP BY or an aggregate before '" + tokens[t].text + "'");
+        }
+        if(t < tokens.size() && isQueryKeyword(tokens[t], "AND")) {
+            t++;
+            if(t >= tokens.size() || endsQueryValue(tokens[t])) {
+                throw invalid_argument("expected a filter after AND");
+            }
+        }
+    }
+    
+    // Clauses
+    while(t < tokens.size()) {
+        const QueryToken& token = tokens[t++];
+        if(isQueryKeyword(token, "GROUP")) {
+            if(t < tokens.size() && isQueryKeyword(tokens[t], "BY")) {
+                t++;
+            }
+            if(t >= tokens.size()) {
+                throw invalid_argument("expected a column after GROUP BY");
+            }
+            query.grouped = true;
+            query.groupBy = parseQueryColumn(tokens[t++]);
+        } else if(isQueryKeyword(token, "LIMIT")) {
+            if(t >= tokens.size()) {
+                throw invalid_argument("expected a number after LIMIT");
+            }
+            query.limit = (int)max(0LL, parseQueryValue(QUERY_QUANTITY, tokens[t++].text));
+        } else if(isQueryKeyword(token, "COUNT")) {
+            QueryAggregate aggregate = {AGG_COUNT, QUERY_ORDER_ID};
+            query.aggregates.push_back(aggregate);
+            if(t < tokens.size() && tokens[t].text == "*") {
+                t++;
+            }
+        } else {
+            const char* names[] = {"SUM", "AVG", "MIN", "MAX"};
+            const AggregateKind kinds[] = {AGG_SUM, AGG_AVG, AGG_MIN, AGG_MAX};
+            int k = 0;
+            while(k < 4 && !isQueryKeyword(token, names[k])) {
+                k++;
+            }
+            if(k == 4) {
+                throw invalid_argument("unexpected '" + token.text + "'");
+            }
+            if(t >= tokens.size()) {
+                throw invalid_argument(string("expected a column after ") + names[k]);
+            }
+            QueryAggregate aggregate = {kinds[k], parseQueryColumn(tokens[t++])};
+            if(isStringColumn(aggregate.column)) {
+                throw invalid_argument(string(names[k]) + " needs a numeric column");
+            }
+            query.aggregates.push_back(aggregate);
+        }
+    }
+    if(query.aggregates.empty()) {
+        QueryAggregate aggregate = {AGG_COUNT, QUERY_ORDER_ID};
+        query.aggregates.push_back(aggregate);
+    }
+    if(query.grouped && isStringColumn(query.groupBy)) {
+        compileDictionary(query, query.groupBy);
+    }
+    
+    // Drop filters that keep every row, spot ones that keep none, then run
+    // the most selective first so later filters see the fewest rows
+    vector<CompiledFilter> kept;
+    for(size_t f = 0; f < query.filters.size(); f++) {
+        CompiledFilter& filter = query.filters[f];
+        filter.rowsIn = 0;
+        filter.rowsOut = 0;
+        if(filter.kind == FILTER_CODES) {
+            const DictionaryColumn& dict = queryDictionaries[filter.column - QUERY_CUSTOMER];
+            long long rows = 0;
+            for(size_t code = 0; code < dict.counts.size(); code++) {
+                rows += filter.codeMatches[code] ? dict.counts[code] : 0;
+            }
+            filter.estimate = dict.codes.empty() ? 0 : (double)rows / dict.codes.size();
+        } else if(filter.kind == FILTER_RANGE && filter.lo > filter.hi) {
+            filter.estimate = 0;
+        } else if(filter.kind == FILTER_RANGE && filter.lo == LLONG_MIN && filter.hi == LLONG_MAX) {
+            filter.estimate = 1;
+        } else {
+            filter.estimate = estimateRangeFilter(filter);
+        }
+        
+        if(filter.estimate == 0 && (filter.kind == FILTER_CODES || filter.lo > filter.hi)) {
+            query.neverMatches = true;
+            query.notes.push_back(describeFilter(filter) + " matches no rows; scan skipped");
+        } else if(filter.estimate == 1 && filter.kind == FILTER_CODES) {
+            query.notes.push_back(describeFilter(filter) + " matches every row; dropped");
+        } else if(filter.kind == FILTER_RANGE && filter.lo == LLONG_MIN && filter.hi == LLONG_MAX) {
+            query.notes.push_back(describeFilter(filter) + " matches every row; dropped");
+        } else {
+            kept.push_back(filter);
+        }
+    }
+    stable_sort(kept.begin(), kept.end(), [](const CompiledFilter& a, const CompiledFilter& b) {
+        return a.estimate < b.estimate;
+    });
+    query.filters.swap(kept);
+    
+    query.compileTime = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() / 1000000.0;
+    return query;
+}
+
+// The packed copy of a numeric column, or nullptr for text columns
+const PackedColumn* packedQueryColumn(const CompressedOrderStore& store, QueryColumn column) {
+    switch(column) {
+        case QUERY_ORDER_ID: return &store.orderID;
+        case QUERY_QUANTITY: return &store.quantity;
+        case QUERY_UNIT_PRICE: return &store.unitPrice;
+        case QUERY_TOTAL_AMOUNT: return &store.totalAmount;
+        default: return nullptr;
+    }
+}
+
+// An ungrouped COUNT/SUM query with at most one numeric range filter is
+// answered from the packed blocks, skipping blocks by zone map
+bool runCompressedQuery(CompiledQuery& query, QueryResult& result) {
+    if(query.grouped || query.neverMatches || query.filters.size() > 1 ||
+       (query.filters.size() == 1 && query.filters[0].kind != FILTER_RANGE)) {
+        return false;
+    }
+    for(size_t a = 0; a < query.aggregates.size(); a++) {
+        if(query.aggregates[a].kind != AGG_COUNT && query.aggregates[a].kind != AGG_SUM) {
+            return false;
+        }
+    }
+    CompressedOrderStore& store = getCompressedStore();
+    long long rows = 0;
+    for(size_t b = 0; b < store.orderID.blocks.size(); b++) {
+        rows += store.orderID.blocks[b].count;
+    }
+    
+    QueryGroup& group = result.groups[0];
+    group.count = rows;
+    const PackedColumn* filterColumn = nullptr;
+    CompiledFilter* filter = nullptr;
+    if(!query.filters.empty()) {
+        filter = &query.filters[0];
+        filterColumn = packedQueryColumn(store, filter->column);
+        group.count = -1;
+    }
+    for(size_t a = 0; a <= query.aggregates.size(); a++) {
+        // One extra pass at the end only if no SUM has produced the count yet
+        bool counting = (a == query.aggregates.size());
+        if(counting && group.count >= 0) {
+            break;
+        }
+        if(!counting && query.aggregates[a].kind != AGG_SUM) {
+            continue;
+        }
+        const PackedColumn* sumColumn = counting ? filterColumn : packedQueryColumn(store, query.aggregates[a].column);
+        long long sum;
+        if(filter == nullptr) {
+            sum = sumCompressedColumn(*sumColumn);
+            result.batches += (int)sumColumn->blocks.size();
+        } else {
+            CompressedScanResult scan = scanCompressedRange(*filterColumn, filter->lo, filter->hi, *sumColumn);
+            sum = scan.sum;
+            group.count = scan.matches;
+            result.batches = scan.blocksScanned + scan.blocksFullMatch;
+            result.batchesSkipped = scan.blocksSkipped;
+            result.filtersProven = scan.blocksFullMatch;
+        }
+        if(!counting) {
+            group.values[a] = sum;
+        }
+    }
+    if(filter != nullptr) {
+        filter->rowsIn = 0;
+        for(size_t b = 0; b < filterColumn->blocks.size(); b++) {
+            const PackedBlock& zone = filterColumn->blocks[b];
+            if(zone.maxValue >= filter->lo && zone.minValue <= filter->hi) {
+                filter->rowsIn += zone.count;
+            }
+        }
+        filter->rowsOut = group.count;
+    }
+    for(size_t a = 0; a < query.aggregates.size(); a++) {
+        if(query.aggregates[a].kind == AGG_COUNT) {
+            group.values[a] = group.count;
+        }
+    }
+    result.rowsScanned = rows;
+    result.rowsMatched = group.count;
+    result.compressedScan = true;
+    return true;
+}
+
+QueryResult runQuery(CompiledQuery& query) {
+    ScopedTimer timer(TIMER_QUERY);
+    OrderColumns& cols = getScanColumns();
+    int n = (int)cols.rows.size();
+    int aggregateCount = (int)query.aggregates.size();
+    
+    QueryResult result;
+    result.rowsScanned = 0;
+    result.rowsMatched = 0;
+    result.batches = 0;
+    result.batchesSkipped = 0;
+    result.filtersProven = 0;
+    result.compressedScan = false;
+    
+    QueryGroup empty;
+    empty.key = 0;
+    empty.count = 0;
+    empty.values.assign(aggregateCount, 0);
+    for(int a = 0; a < aggregateCount; a++) {
+        if(query.aggregates[a].kind == AGG_MIN) empty.values[a] = LLONG_MAX;
+        if(query.aggregates[a].kind == AGG_MAX) empty.values[a] = LLONG_MIN;
+    }
+    if(!query.grouped) {
+        result.groups.push_back(empty);
+        if(runCompressedQuery(query, result)) {
+            result.executionTime = timer.stop();
+            return result;
+        }
+    }
+    
+    // Zone maps of the range-filtered columns, one block per batch
+    vector<const PackedColumn*> zoneMaps(query.filters.size(), nullptr);
+    for(size_t f = 0; f < query.filters.size() && !query.neverMatches; f++) {
+        if(query.filters[f].kind == FILTER_RANGE) {
+            zoneMaps[f] = packedQueryColumn(getCompressedStore(), query.filters[f].column);
+        }
+    }
+    vector<char> proven(query.filters.size(), 0);
+    
+    // Group slots: indexed by dictionary code for string keys, hashed otherwise
+    bool codeGroups = query.grouped && isStringColumn(query.groupBy);
+    const int* groupCodes = nullptr;
+    vector<int> slotByCode;
+    unordered_map<long long, int> slotByValue;
+    if(codeGroups) {
+        DictionaryColumn& dict = getQueryDictionary(query.groupBy);
+        groupCodes = dict.codes.data();
+        slotByCode.assign(dict.values.size(), -1);
+    }
+    
+    int selection[QUERY_BATCH_SIZE];
+    int slots[QUERY_BATCH_SIZE];
+    long long values[QUERY_BATCH_SIZE];
+    
+    for(int begin = 0; begin < n && !query.neverMatches; begin += QUERY_BATCH_SIZE) {
+        int count = min(QUERY_BATCH_SIZE, n - begin);
+        result.rowsScanned += count;
+        
+        // A batch whose block lies outside a range is skipped; a filter
+        // whose range covers the whole block is not evaluated for it
+        bool skip = false;
+        int block = begin / COLUMN_BLOCK_SIZE;
+        for(size_t f = 0; f < query.filters.size(); f++) {
+            proven[f] = 0;
+            if(zoneMaps[f] != nullptr) {
+                const PackedBlock& zone = zoneMaps[f]->blocks[block];
+                const CompiledFilter& filter = query.filters[f];
+                skip = skip || zone.maxValue < filter.lo || zone.minValue > filter.hi;
+                proven[f] = zone.minValue >= filter.lo && zone.maxValue <= filter.hi;
+            }
+        }
+        if(skip) {
+            result.batchesSkipped++;
+            continue;
+        }
+        result.batches++;
+        
+        const int* in = nullptr;
+        for(size_t f = 0; f < query.filters.size() && count > 0; f++) {
+            CompiledFilter& filter = query.filters[f];
+            filter.rowsIn += count;
+            if(proven[f]) {
+                result.filtersProven++;
+            } else {
+                count = filter.kernel(filter, in, count, begin, selection);
+                in = selection;
+            }
+            filter.rowsOut += count;
+        }
+        if(in == nullptr) {
+            for(int s = 0; s < count; s++) {
+                selection[s] = begin + s;
+            }
+        }
+        if(count == 0) {
+            continue;
+        }
+        result.rowsMatched += count;
+        
+        if(!query.grouped) {
+            memset(slots, 0, sizeof(int) * count);
+        } else if(codeGroups) {
+            for(int s = 0; s < count; s++) {
+                int code = groupCodes[selection[s]];
+                if(slotByCode[code] < 0) {
+                    slotByCode[code] = (int)result.groups.size();
+                    result.groups.push_back(empty);
+                    result.groups.back().key = code;
+                }
+                slots[s] = slotByCode[code];
+            }
+        } else {
+            gatherQueryColumn(cols, query.groupBy, selection, count, values);
+            for(int s = 0; s < count; s++) {
+                unordered_map<long long, int>::iterator found = slotByValue.find(values[s]);
+                if(found == slotByValue.end()) {
+                    found = slotByValue.insert(make_pair(values[s], (int)result.groups.size())).first;
+                    result.groups.push_back(empty);
+                    result.groups.back().key = values[s];
+                }
+                slots[s] = found->second;
+            }
+        }
+        
+        QueryGroup* groups = &result.groups[0];
+        for(int s = 0; s < count; s++) {
+            groups[slots[s]].count++;
+        }
+        for(int a = 0; a < aggregateCount; a++) {
+            AggregateKind kind = query.aggregates[a].kind;
+            if(kind == AGG_COUNT) {
+                continue;
+            }
+            gatherQueryColumn(cols, query.aggregates[a].column, selection, count, values);
+            if(kind == AGG_SUM || kind == AGG_AVG) {
+                for(int s = 0; s < count; s++) {
+                    groups[slots[s]].values[a] += values[s];
+                }
+            } else if(kind == AGG_MIN) {
+                for(int s = 0; s < count; s++) {
+                    long long& current = groups[slots[s]].values[a];
+                    current = min(current, values[s]);
+                }
+            } else {
+                for(int s = 0; s < count; s++) {
+                    long long& current = groups[slots[s]].values[a];
+                    current = max(current, values[s]);
+                }
+            }
+        }
+    }
+    
+    for(size_t g = 0; g < result.groups.size(); g++) {
+        for(int a = 0; a < aggregateCount; a++) {
+            if(query.aggregates[a].kind == AGG_COUNT) {
+                result.groups[g].values[a] = result.groups[g].count;
+            }
+        }
+    }
+    // Largest first aggregate first, comparing averages rather than the
+    // sums AVG accumulates (empty groups sort last)
+    bool byAverage = query.aggregates[0].kind == AGG_AVG;
+    sort(result.groups.begin(), result.groups.end(), [byAverage](const QueryGroup& a, const QueryGroup& b) {
+        if(byAverage) {
+            if((a.count == 0) != (b.count == 0)) {
+                return b.count == 0;
+            }
+            long double averageA = a.count ? (long double)a.values[0] / a.count : 0;
+            long double averageB = b.count ? (long double)b.values[0] / b.count : 0;
+            if(averageA != averageB) {
+                return averageA > averageB;
+            }
+        } else if(a.values[0] != b.values[0]) {
+            return a.values[0] > b.values[0];
+        }
+        return a.key < b.key;
+    });
+    
+    result.executionTime = timer.stop();
+    return result;
+}
+
+string aggregateLabel(const QueryAggregate& aggregate) {
+    const char* names[] = {"COUNT", "SUM", "AVG", "MIN", "MAX"};
+    if(aggregate.kind == AGG_COUNT) {
+        return "COUNT";
+    }
+    return string(names[aggregate.kind]) + "(" + QUERY_COLUMN_NAMES[aggregate.column] + ")";
+}
+
+string formatAggregate(const QueryAggregate& aggregate, const QueryGroup& group, int a) {
+    long long value = group.values[a];
+    if(aggregate.kind == AGG_COUNT) {
+        return to_string(value);
+    }
+    if(group.count == 0 && aggregate.kind != AGG_SUM) {
+        return "-";
+    }
+    if(aggregate.kind == AGG_AVG) {
+        if(isMoneyColumn(aggregate.column)) {
+            return formatNumber((value + (value >= 0 ? 1 : -1) * group.count / 2) / group.count);
+        }
+        stringstream out;
+        out << fixed << setprecision(2) << (double)value / group.count;
+        return out.str();
+    }
+    return isMoneyColumn(aggregate.column) ? formatNumber(value) : to_string(value);
+}
+
+void printQueryPlan(const CompiledQuery& query, const QueryResult& result) {
+    cout << "  Query Plan\n";
+    cout << "  ------------------------------------------------------------\n";
+    if(result.compressedScan) {
+        cout << "  Scan        " << result.rowsScanned << " rows from the compressed columns, "
+             << result.batches << " blocks read\n";
+    } else {
+        cout << "  Scan        " << result.rowsScanned << " rows, " << result.batches
+             << " batches of " << QUERY_BATCH_SIZE << " evaluated\n";
+    }
+    if(result.batchesSkipped > 0 || result.filtersProven > 0) {
+        cout << "  Zone Map    " << result.batchesSkipped << " batches skipped, "
+             << result.filtersProven << " filter checks proven from block min/max\n";
+    }
+    for(size_t f = 0; f < query.filters.size(); f++) {
+        const CompiledFilter& filter = query.filters[f];
+        cout << "  Filter " << (f + 1) << "    " << setw(36) << left << describeFilter(filter) << right
+             << " est " << setw(6) << fixed << setprecision(2) << filter.estimate * 100 << "%"
+             << "  rows " << filter.rowsIn << " -> " << filter.rowsOut << "\n";
+    }
+    for(size_t note = 0; note < query.notes.size(); note++) {
+        cout << "  Compile     " << query.notes[note] << "\n";
+    }
+    if(query.grouped) {
+        cout << "  Group By    " << QUERY_COLUMN_NAMES[query.groupBy]
+             << (isStringColumn(query.groupBy) ? " (dictionary codes)\n" : " (hashed values)\n");
+    }
+    cout << "  Aggregate  ";
+    for(size_t a = 0; a < query.aggregates.size(); a++) {
+        cout << (a ? ", " : " ") << aggregateLabel(query.aggregates[a]);
+    }
+    cout << "\n  ------------------------------------------------------------\n";
+}
+
+void printQueryResult(const CompiledQuery& query, const QueryResult& result) {
+    const int keyWidth = 22;
+    vector<int> widths;
+    string border = "  +";
+    if(query.grouped) {
+        border += string(keyWidth + 2, '-') + "+";
+    }
+    for(size_t a = 0; a < query.aggregates.size(); a++) {
+        widths.push_back(max(16, (int)aggregateLabel(query.aggregates[a]).size()));
+        border += string(widths[a] + 2, '-') + "+";
+    }
+    border += "\n";
+    
+    cout << border << "  |";
+    if(query.grouped) {
+        cout << " " << setw(keyWidth) << left << QUERY_COLUMN_NAMES[query.groupBy] << " |";
+    }
+    for(size_t a = 0; a < query.aggregates.size(); a++) {
+        cout << " " << setw(widths[a]) << right << aggregateLabel(query.aggregates[a]) << " |";
+    }
+    cout << "\n" << border;
+    
+    int shown = min((int)result.groups.size(), query.grouped ? query.limit : 1);
+    for(int g = 0; g < shown; g++) {
+        const QueryGroup& group = result.groups[g];
+        cout << "  |";
+        if(query.grouped) {
+            string key = isStringColumn(query.groupBy)
+                ? queryDictionaries[query.groupBy - QUERY_CUSTOMER].values[group.key]
+                : formatQueryKey(query.groupBy, group.key);
+            cout << " " << setw(keyWidth) << left << key.substr(0, keyWidth) << " |";
+        }
+        for(size_t a = 0; a < query.aggregates.size(); a++) {
+            cout << " " << setw(widths[a]) << right << formatAggregate(query.aggregates[a], group, (int)a) << " |";
+        }
+        cout << "\n";
+    }
+    cout << border;
+    if((int)result.groups.size() > shown) {
+        cout << "  ... " << (result.groups.size() - shown) << " more groups (use LIMIT n)\n";
+    }
+}
+
+// Compiles, runs and prints one query; false on a syntax error
+bool executeQuery(const string& text) {
+    CompiledQuery query;
+    try {
+        query = compileQuery(text);
+    } catch(const invalid_argument& error) {
+        cout << "  Query error: " << error.what() << "\n";
+        return false;
+    }
+    QueryResult result = runQuery(query);
+    
+    printQueryPlan(query, result);
+    printQueryResult(query, result);
+    cout << "  Rows Matched: " << result.rowsMatched << " of " << result.rowsScanned;
+    if(query.grouped) {
+        cout << ", Groups: " << result.groups.size();
+    }
+    cout << "\n  Compile Time: " << fixed << setprecision(4) << query.compileTime << " ms\n";
+    cout << "  Execution Time: " << fixed << setprecision(4) << result.executionTime << " ms\n";
+    return true;
+}
+
+void queryEngineMenu() {
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "                       QUERY ENGINE                        \n";
+    cout << "============================================================\n";
+    printPartialDataNote();
+    cout << "  [WHERE] column op value [AND ...] [GROUP BY column]\n";
+    cout << "  [COUNT | SUM|AVG|MIN|MAX column ...] [LIMIT n]\n\n";
+    cout << "  Columns: ";
+    for(int c = 0; c < QUERY_COLUMN_COUNT; c++) {
+        cout << (c ? ", " : "") << QUERY_COLUMN_NAMES[c];
+    }
+    cout << "\n  Operators: = != < <= > >=  (text is case-insensitive; quote values with spaces)\n";
+    cout << "  e.g. category = Books AND quantity >= 10 GROUP BY productName SUM totalAmount\n";
+    
+    cin.ignore();
+    while(true) {
+        cout << "\n  Query (blank line to return): ";
+        string text;
+        if(!getline(cin, text) || text.find_first_not_of(" \t\r") == string::npos) {
+            break;
+        }
+        cout << "\n";
+        executeQuery(text);
+    }
+}
+
+// ---------------------------------------------------------------------
+// Task scheduler
+// ---------------------------------------------------------------------
+
+thread_local int currentWorkerIndex = -1;
+
+bool takeTask(int self, ScheduledTask& task) {
+    TaskScheduler& sched = taskScheduler;
+    int workerCount = (int)sched.queues.size();
+    
+    // Own deque first, newest task (keeps fork-join work cache-warm)
+    if(self >= 0) {
+        WorkerQueue& own = *sched.queues[self];
+        lock_guard<mutex> lock(own.lock);
+        if(!own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+            own.depth--;
+            sched.queuedTasks--;
+            return true;
+        }
+    }
+    
+    // Otherwise steal the oldest task from someone else
+    int offset = (self >= 0) ? self + 1 : (int)(sched.nextQueue++ % workerCount);
+    for(int k = 0; k < workerCount; k++) {
+        int victim = (offset + k) % workerCount;
+        if(victim == self) continue;
+        WorkerQueue& other = *sched.queues[victim];
+        lock_guard<mutex> lock(other.lock);
+        if(!other.tasks.empty()) {
+            task = other.tasks.front();
+            other.tasks.pop_front();
+            other.depth--;
+            sched.queuedTasks--;
+            if(self >= 0) {
+                sched.queues[self]->steals++;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void runTask(int self, ScheduledTask& task) {
+    auto start = high_resolution_clock::now();
+    task.run();
+    auto end = high_resolution_clock::now();
+    if(self >= 0) {
+        WorkerQueue& own = *taskScheduler.queues[self];
+        own.executed++;
+        own.busyNanos += duration_cast<nanoseconds>(end - start).count();
+    } else {
+        taskScheduler.helperExecuted++;
+    }
+    TaskGroup* group = task.group;
+    lock_guard<mutex> lock(group->lock);
+    if(--group->pending == 0) {
+        group->finished.notify_all();
+    }
+}
+
+void workerLoop(int self) {
+    currentWorkerIndex = self;
+    TaskScheduler& sched = taskScheduler;
+    while(!sched.stopping) {
+        ScheduledTask task;
+        if(takeTask(self, task)) {
+            runTask(self, task);
+            continue;
+        }
+        unique_lock<mutex> lock(sched.sleepLock);
+        if(sched.queuedTasks == 0 && !sched.stopping) {
+            sched.wake.wait_for(lock, milliseconds(5));
+        }
+    }
+}
+
+// Safe to call from any thread: the loader, shard and menu threads can all
+// spawn the first task at the same time
+void startTaskScheduler() {
+    TaskScheduler& sched = taskScheduler;
+    if(sched.running) {
+        return;
+    }
+    lock_guard<mutex> lock(sched.startLock);
+    if(sched.running) {
+        return;
+    }
+    int workerCount = (int)thread::hardware_concurrency();
+    const char* configured = getenv("OSOMS_THREADS");
+    if(configured != nullptr && atoi(configured) > 0) {
+        workerCount = atoi(configured);
+    }
+    workerCount = max(workerCount, 1);
+    
+    sched.startTime = high_resolution_clock::now();
+    for(int i = 0; i < workerCount; i++) {
+        sched.queues.push_back(new WorkerQueue());
+    }
+    for(int i = 0; i < workerCount; i++) {
+        sched.workers.push_back(thread(workerLoop, i));
+    }
+    sched.running = true;
+}
+
+// Call only once no other thread is spawning tasks
+void stopTaskScheduler() {
+    TaskScheduler& sched = taskScheduler;
+    lock_guard<mutex> lock(sched.startLock);
+    if(!sched.running) {
+        return;
+    }
+    sched.running = false;
+    sched.stopping = true;
+    sched.wake.notify_all();
+    for(size_t i = 0; i < sched.workers.size(); i++) {
+        sched.workers[i].join();
+    }
+    for(size_t i = 0; i < sched.queues.size(); i++) {
+        delete sched.queues[i];
+    }
+    sched.workers.clear();
+    sched.queues.clear();
+    sched.queuedTasks = 0;
+    sched.stopping = false;
+}
+
+void spawnTask(TaskGroup& group, const function<void()>& run) {
+    TaskScheduler& sched = taskScheduler;
+    startTaskScheduler();
+    
+    int target = currentWorkerIndex;
+    if(target < 0) {
+        target = (int)(sched.nextQueue++ % sched.queues.size());
+    }
+    WorkerQueue& queue = *sched.queues[target];
+    
+    ScheduledTask task;
+    task.run = run;
+    task.group = &group;
+    group.pending++;
+    {
+        lock_guard<mutex> lock(queue.lock);
+        queue.tasks.push_back(task);
+        queue.depth++;
+        if((int)queue.tasks.size() > queue.peakDepth) {
+            queue.peakDepth = (int)queue.tasks.size();
+        }
+    }
+    sched.queuedTasks++;
+    sched.submitted++;
+    sched.wake.notify_one();
+}
+
+// Blocks until every task in the group has finished, running queued
+// tasks in the meantime; with nothing to run it sleeps until one of the
+// group's tasks finishes (or briefly, to look for new work to help with)
+void waitTaskGroup(TaskGroup& group) {
+    while(group.pending > 0) {
+        ScheduledTask task;
+        if(takeTask(currentWorkerIndex, task)) {
+            runTask(currentWorkerIndex, task);
+            continue;
+        }
+        unique_lock<mutex> lock(group.lock);
+        if(group.pending > 0) {
+            group.finished.wait_for(lock, milliseconds(1));
+        }
+    }
+    // The last task signals while holding the lock; taking it here ensures
+    // that task is done with the group before the caller destroys it
+    lock_guard<mutex> lock(group.lock);
+}
+
+void parallelFor(int begin, int end, int grain, const function<void(int, int)>& body) {
+    if(end - begin <= grain) {
+        if(end > begin) {
+            body(begin, end);
+        }
+        return;
+    }
+    TaskGroup group;
+    for(int first = begin; first < end; first += grain) {
+        int last = min(end, first + grain);
+        spawnTask(group, [&body, first, last]() { body(first, last); });
+    }
+    waitTaskGroup(group);
+}
+
+void taskSchedulerStatus() {
+    clearScreen();
+    startTaskScheduler();
+    TaskScheduler& sched = taskScheduler;
+    double uptimeNanos = (double)duration_cast<nanoseconds>(high_resolution_clock::now() - sched.startTime).count();
+    
+    cout << "\n============================================================\n";
+    cout << "                   THREAD POOL STATUS                      \n";
+    cout << "============================================================\n";
+    cout << "  Workers:          " << sched.queues.size() << "\n";
+    cout << "  Tasks Submitted:  " << sched.submitted.load() << "\n";
+    cout << "  Queued Now:       " << sched.queuedTasks.load() << "\n";
+    cout << "  Run by Waiters:   " << sched.helperExecuted.load() << "\n";
+    cout << "  +--------+------------+----------+-------+-------+------------+\n";
+    cout << "  | Worker | Executed   | Steals   | Depth | Peak  | Busy %     |\n";
+    cout << "  +--------+------------+----------+-------+-------+------------+\n";
+    for(size_t i = 0; i < sched.queues.size(); i++) {
+        WorkerQueue& queue = *sched.queues[i];
+        double busy = (uptimeNanos > 0) ? queue.busyNanos.load() * 100.0 / uptimeNanos : 0.0;
+        cout << "  | " << setw(6) << right << i
+             << " | " << setw(10) << queue.executed.load()
+             << " | " << setw(8) << queue.steals.load()
+             << " | " << setw(5) << queue.depth.load()
+             << " | " << setw(5) << queue.peakDepth.load()
+             << " | " << setw(10) << fixed << setprecision(2) << busy << " |\n";
+    }
+    cout << "  +--------+------------+----------+-------+-------+------------+\n";
+    cout << "  Set OSOMS_THREADS to change the worker count.\n";
+    pauseScreen();
+}
+
+// ---------------------------------------------------------------------
+// Compressed column storage
+// ---------------------------------------------------------------------
+
+int bitsNeeded(unsigned long long value) {
+    int bits = 0;
+    while(value != 0) {
+        bits++;
+        value >>= 1;
+    }
+    return bits;
+}
+
+void packColumn(PackedColumn& column, const vector<long long>& values) {
+    column.blocks.clear();
+    column.words.clear();
+    
+    for(size_t start = 0; start < values.size(); start += COLUMN_BLOCK_SIZE) {
+        PackedBlock block;
+        block.count = (int)min((size_t)COLUMN_BLOCK_SIZE, values.size() - start);
+        block.minValue = block.maxValue = values[start];
+        for(int i = 1; i < block.count; i++) {
+            block.minValue = min(block.minValue, values[start + i]);
+            block.maxValue = max(block.maxValue, values[start + i]);
+        }
+        block.bitWidth = bitsNeeded((unsigned long long)(block.maxValue - block.minValue));
+        block.wordOffset = column.words.size();
+        column.words.resize(column.words.size() + ((size_t)block.count * block.bitWidth + 63) / 64, 0);
+        
+        uint64_t* words = &column.words[0] + block.wordOffset;
+        for(int i = 0; i < block.count && block.bitWidth > 0; i++) {
+            uint64_t delta = (uint64_t)(values[start + i] - block.minValue);
+            size_t bitPos = (size_t)i * block.bitWidth;
+            int shift = (int)(bitPos & 63);
+            words[bitPos >> 6] |= delta << shift;
+            if(shift + block.bitWidth > 64) {
+                words[(bitPos >> 6) + 1] |= delta >> (64 - shift);
+            }
+        }
+        column.blocks.push_back(block);
+    }
+}
+
+// Decodes block b into out[0..count-1] and returns the count
+int unpackBlock(const PackedColumn& column, size_t b, long long* out) {
+    const PackedBlock& block = column.blocks[b];
+    if(block.bitWidth == 0) {
+        for(int i = 0; i < block.count; i++) {
+            out[i] = block.minValue;
+        }
+        return block.count;
+    }
+    const uint64_t* words = &column.words[0] + block.wordOffset;
+    uint64_t mask = (block.bitWidth == 64) ? ~0ULL : ((1ULL << block.bitWidth) - 1);
+    for(int i = 0; i < block.count; i++) {
+        size_t bitPos = (size_t)i * block.bitWidth;
+        int shift = (int)(bitPos & 63);
+        uint64_t value = words[bitPos >> 6] >> shift;
+        if(shift + block.bitWidth > 64) {
+            value |= words[(bitPos >> 6) + 1] << (64 - shift);
+        }
+        out[i] = block.minValue + (long long)(value & mask);
+    }
+    return block.count;
+}
+
+size_t packedColumnBytes(const PackedColumn& column) {
+    return column.words.size() * sizeof(uint64_t) + column.blocks.size() * sizeof(PackedBlock);
+}
+
+CompressedOrderStore& getCompressedStore() {
+    CompressedOrderStore& store = compressedStore;
+    if(store.builtVersion == layoutVersion) {
+        return store;
+    }
+    OrderColumns& cols = getScanColumns();
+    auto start = high_resolution_clock::now();
     
-    Order** arr = convertToArray();
-    Order sentinel;
-    sentinel.orderID = searchOrderID;
-    sentinel.customerName = searchName;
+    size_t n = cols.rows.size();
+    vector<long long> ids(n), quantities(n), prices(n), amounts(n);
+    for(size_t i = 0; i < n; i++) {
+        ids[i] = cols.orderID[i];
+        quantities[i] = cols.quantity[i];
+        prices[i] = cols.unitPrice[i];
+        amounts[i] = cols.totalAmount[i];
+    }
+    packColumn(store.orderID, ids);
+    packColumn(store.quantity, quantities);
+    packColumn(store.unitPrice, prices);
+    packColumn(store.totalAmount, amounts);
+    
+    auto end = high_resolution_clock::now();
+    store.buildTime = duration_cast<microseconds>(end - start).count() / 1000.0;
+    store.builtVersion = layoutVersion;
+    return store;
+}
+
+// Counts rows with lo <= filter <= hi and sums sumColumn over them,
+// decoding only blocks the zone map cannot rule in or out
+CompressedScanResult scanCompressedRange(const PackedColumn& filter, long long lo, long long hi,
+                                         const PackedColumn& sumColumn) {
+    CompressedScanResult result = {0, 0, 0, 0, 0};
+    long long filterValues[COLUMN_BLOCK_SIZE];
+    long long sumValues[COLUMN_BLOCK_SIZE];
+    
+    for(size_t b = 0; b < filter.blocks.size(); b++) {
+        const PackedBlock& block = filter.blocks[b];
+        if(block.maxValue < lo || block.minValue > hi) {
+            result.blocksSkipped++;
+            continue;
+        }
+        int count = unpackBlock(sumColumn, b, sumValues);
+        if(block.minValue >= lo && block.maxValue <= hi) {
+            result.blocksFullMatch++;
+            for(int i = 0; i < count; i++) {
+                result.sum += sumValues[i];
+            }
+            result.matches += count;
+            continue;
+        }
+        result.blocksScanned++;
+        unpackBlock(filter, b, filterValues);
+        for(int i = 0; i < count; i++) {
+            bool match = filterValues[i] >= lo && filterValues[i] <= hi;
+            result.matches += match;
+            result.sum += match ? sumValues[i] : 0;
+        }
+    }
+    return result;
+}
+
+long long sumCompressedColumn(const PackedColumn& column) {
+    long long values[COLUMN_BLOCK_SIZE];
+    long long sum = 0;
+    for(size_t b = 0; b < column.blocks.size(); b++) {
+        int count = unpackBlock(column, b, values);
+        for(int i = 0; i < count; i++) {
+            sum += values[i];
+        }
+    }
+    return sum;
+}
+
+void compressedStorageReport() {
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "             COMPRESSED COLUMN STORAGE REPORT              \n";
+    cout << "============================================================\n";
+    printPartialDataNote();
+    
+    OrderColumns& cols = getScanColumns();
+    CompressedOrderStore& store = getCompressedStore();
+    size_t n = cols.rows.size();
+    
+    struct ColumnInfo {
+        const char* name;
+        const PackedColumn* packed;
+        size_t rawBytes;
+    };
+    ColumnInfo columns[4] = {
+        {"Order ID", &store.orderID, n * sizeof(int)},
+        {"Quantity", &store.quantity, n * sizeof(int)},
+        {"Unit Price", &store.unitPrice, n * sizeof(Money)},
+        {"Total Amount", &store.totalAmount, n * sizeof(Money)}
+    };
+    
+    cout << "  Block size: " << COLUMN_BLOCK_SIZE << " rows, " << store.orderID.blocks.size() << " blocks per column\n";
+    cout << "  Build Time: " << fixed << setprecision(4) << store.buildTime << " ms\n\n";
+    cout << "  +--------------+--------------+--------------+---------+----------+\n";
+    cout << "  | Column       | Raw (bytes)  | Packed       | Ratio   | Avg Bits |\n";
+    cout << "  +--------------+--------------+--------------+---------+----------+\n";
+    size_t rawTotal = 0, packedTotal = 0;
+    for(int c = 0; c < 4; c++) {
+        const PackedColumn& packed = *columns[c].packed;
+        double bits = 0;
+        for(size_t b = 0; b < packed.blocks.size(); b++) {
+            bits += packed.blocks[b].bitWidth * (double)packed.blocks[b].count;
+        }
+        size_t packedBytes = packedColumnBytes(packed);
+        rawTotal += columns[c].rawBytes;
+        packedTotal += packedBytes;
+        cout << "  | " << setw(12) << left << columns[c].name
+             << " | " << setw(12) << right << columns[c].rawBytes
+             << " | " << setw(12) << packedBytes
+             << " | " << setw(6) << setprecision(2) << (packedBytes ? (double)columns[c].rawBytes / packedBytes : 0.0) << "x"
+             << " | " << setw(8) << setprecision(2) << (n ? bits / n : 0.0) << " |\n";
+    }
+    cout << "  +--------------+--------------+--------------+---------+----------+\n";
+    cout << "  | TOTAL        | " << setw(12) << right << rawTotal << " | " << setw(12) << packedTotal
+         << " | " << setw(6) << setprecision(2) << (packedTotal ? (double)rawTotal / packedTotal : 0.0) << "x |          |\n";
+    cout << "  +--------------+--------------+--------------+---------+----------+\n";
+    
+    // Same queries over the packed blocks and the plain scan columns
+    const int REPEATS = 20;
+    double amountLo, amountHi;
+    cout << "\n  Range filter on Total Amount (RM)\n";
+    cout << "  Enter minimum: ";
+    cin >> amountLo;
+    cout << "  Enter maximum: ";
+    cin >> amountHi;
+    if(!cin || !moneyInputInRange(amountLo) || !moneyInputInRange(amountHi)) {
+        cin.clear();
+        amountLo = 1000;
+        amountHi = 2000;
+    }
     
+    Money centsLo = toCents(amountLo);
+    Money centsHi = toCents(amountHi);
+    CompressedScanResult packedRange = {0, 0, 0, 0, 0};
     auto start = high_resolution_clock::now();
+    for(int r = 0; r < REPEATS; r++) {
+        packedRange = scanCompressedRange(store.totalAmount, centsLo, centsHi, store.totalAmount);
+    }
+    double packedRangeTime = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() / 1000000.0 / REPEATS;
     
-    Order** tempArr = new Order*[orderCount + 1];
-    for(int i = 0; i < orderCount; i++) {
-        tempArr[i] = arr[i];
+    long long plainMatches = 0;
+    Money plainSum = 0;
+    start = high_resolution_clock::now();
+    for(int r = 0; r < REPEATS; r++) {
+        plainMatches = 0;
+        plainSum = 0;
+        const Money* amounts = cols.totalAmount.data();
+        for(size_t i = 0; i < n; i++) {
+            bool match = amounts[i] >= centsLo && amounts[i] <= centsHi;
+            plainMatches += match;
+            plainSum += match ? amounts[i] : 0;
+        }
     }
-    tempArr[orderCount] = &sentinel;
+    double plainRangeTime = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() / 1000000.0 / REPEATS;
     
-    int i = 0;
-    while(!(tempArr[i]->orderID == searchOrderID && tempArr[i]->customerName == searchName)) {
-        i++;
+    long long packedSum = 0;
+    start = high_resolution_clock::now();
+    for(int r = 0; r < REPEATS; r++) {
+        packedSum = sumCompressedColumn(store.totalAmount);
     }
+    double packedSumTime = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() / 1000000.0 / REPEATS;
     
-    bool found = (i < orderCount);
+    Money plainTotal = 0;
+    start = high_resolution_clock::now();
+    for(int r = 0; r < REPEATS; r++) {
+        plainTotal = 0;
+        for(size_t i = 0; i < n; i++) {
+            plainTotal += cols.totalAmount[i];
+        }
+    }
+    double plainSumTime = duration_cast<nanoseconds>(high_resolution_clock::now() - start).count() / 1000000.0 / REPEATS;
     
-    auto end = high_resolution_clock::now();
-    double executionTime = duration_cast<microseconds>(end - start).count() / 1000.0;
+    cout << "\n  +----------------------+------------+-------------+-----------------+\n";
+    cout << "  | Query                | Layout     | Time (ms)   | Rows/s (M)      |\n";
+    cout << "  +----------------------+------------+-------------+-----------------+\n";
+    const char* queries[4] = {"Range count + sum", "Range count + sum", "SUM(totalAmount)", "SUM(totalAmount)"};
+    const char* layouts[4] = {"Packed", "Plain", "Packed", "Plain"};
+    double times[4] = {packedRangeTime, plainRangeTime, packedSumTime, plainSumTime};
+    for(int q = 0; q < 4; q++) {
+        cout << "  | " << setw(20) << left << queries[q]
+             << " | " << setw(10) << layouts[q]
+             << " | " << setw(11) << right << fixed << setprecision(4) << times[q]
+             << " | " << setw(15) << setprecision(1) << (times[q] > 0 ? n / times[q] / 1000.0 : 0.0) << " |\n";
+    }
+    cout << "  +----------------------+------------+-------------+-----------------+\n";
+    cout << "  Range matches: " << packedRange.matches << " (plain: " << plainMatches << ")"
+         << ", sum RM " << formatNumber(packedRange.sum) << " (plain: RM " << formatNumber(plainSum) << ")\n";
+    cout << "  Zone map: " << packedRange.blocksSkipped << " blocks skipped, "
+         << packedRange.blocksFullMatch << " fully matched, "
+         << packedRange.blocksScanned << " decoded and filtered\n";
+    cout << "  Total sales: RM " << formatNumber(packedSum) << " (plain: RM " << formatNumber(plainTotal) << ")\n";
+    cout << "  Note: zone maps skip the most blocks after sorting by Total Amount.\n";
+    pauseScreen();
+}
+
+// ---------------------------------------------------------------------
+// Category partitions
+// ---------------------------------------------------------------------
+
+// Returns the partitions, rebuilding them if the list has changed
+CategoryPartitions& getCategoryPartitions() {
+    CategoryPartitions& parts = categoryPartitions;
+    if(parts.builtVersion == layoutVersion) {
+        return parts;
+    }
+    OrderColumns& cols = getScanColumns();
+    ScopedTimer timer(TIMER_PARTITION_BUILD);
+    
+    parts.partitions.clear();
+    size_t last = 0;   // consecutive rows often share a category
+    for(size_t r = 0; r < cols.rows.size(); r++) {
+        const string& category = cols.rows[r]->productCategory;
+        if(last >= parts.partitions.size() || parts.partitions[last].name != category) {
+            last = 0;
+            while(last < parts.partitions.size() && parts.partitions[last].name != category) {
+                last++;
+            }
+            if(last == parts.partitions.size()) {
+                parts.partitions.push_back(CategoryPartition());
+                parts.partitions[last].name = category;
+            }
+        }
+        OrderColumns& part = parts.partitions[last].columns;
+        part.rows.push_back(cols.rows[r]);
+        part.orderID.push_back(cols.orderID[r]);
+        part.quantity.push_back(cols.quantity[r]);
+        part.unitPrice.push_back(cols.unitPrice[r]);
+        part.totalAmount.push_back(cols.totalAmount[r]);
+    }
+    
+    const ScanKernels& kernels = activeScanKernels();
+    for(size_t p = 0; p < parts.partitions.size(); p++) {
+        CategoryPartition& partition = parts.partitions[p];
+        partition.columns.builtVersion = layoutVersion;
+        kernels.sumMinMaxInt64(partition.columns.totalAmount.data(), (int)partition.columns.totalAmount.size(),
+                               partition.salesSum, partition.minAmount, partition.maxAmount);
+        partition.quantitySum = 0;
+        for(size_t r = 0; r < partition.columns.quantity.size(); r++) {
+            partition.quantitySum += partition.columns.quantity[r];
+        }
+    }
+    parts.builtVersion = layoutVersion;
+    parts.buildTime = timer.stop();
+    return parts;
+}
+
+// Adds new rows at the end of their partitions and folds them into the
+// partition aggregates
+void appendToCategoryPartitions(const vector<Order*>& batch) {
+    CategoryPartitions& parts = categoryPartitions;
+    for(size_t i = 0; i < batch.size(); i++) {
+        const Order* order = batch[i];
+        size_t p = 0;
+        while(p < parts.partitions.size() && parts.partitions[p].name != order->productCategory) {
+            p++;
+        }
+        if(p == parts.partitions.size()) {
+            parts.partitions.push_back(CategoryPartition());
+            parts.partitions[p].name = order->productCategory;
+            parts.partitions[p].quantitySum = 0;
+            parts.partitions[p].salesSum = 0;
+            parts.partitions[p].minAmount = order->totalAmount;
+            parts.partitions[p].maxAmount = order->totalAmount;
+        }
+        CategoryPartition& partition = parts.partitions[p];
+        partition.columns.rows.push_back(batch[i]);
+        partition.columns.orderID.push_back(order->orderID);
+        partition.columns.quantity.push_back(order->quantity);
+        partition.columns.unitPrice.push_back(order->unitPrice);
+        partition.columns.totalAmount.push_back(order->totalAmount);
+        partition.quantitySum += order->quantity;
+        partition.salesSum += order->totalAmount;
+        partition.minAmount = min(partition.minAmount, order->totalAmount);
+        partition.maxAmount = max(partition.maxAmount, order->totalAmount);
+    }
+    for(size_t p = 0; p < parts.partitions.size(); p++) {
+        parts.partitions[p].columns.builtVersion = layoutVersion;
+    }
+    parts.builtVersion = layoutVersion;
+}
+
+// Index of the partition named name (case-insensitive), or -1
+int findCategoryPartition(const string& name) {
+    CategoryPartitions& parts = getCategoryPartitions();
+    for(size_t p = 0; p < parts.partitions.size(); p++) {
+        const string& candidate = parts.partitions[p].name;
+        if(candidate.size() != name.size()) {
+            continue;
+        }
+        size_t i = 0;
+        while(i < name.size() && tolower((unsigned char)candidate[i]) == tolower((unsigned char)name[i])) {
+            i++;
+        }
+        if(i == name.size()) {
+            return (int)p;
+        }
+    }
+    return -1;
+}
+
+// Lists the categories and reads one; returns its partition or -1
+int promptCategoryPartition() {
+    CategoryPartitions& parts = getCategoryPartitions();
+    cout << "  Categories:";
+    for(size_t p = 0; p < parts.partitions.size(); p++) {
+        cout << (p ? ", " : " ") << parts.partitions[p].name
+             << " (" << parts.partitions[p].columns.rows.size() << ")";
+    }
+    cout << "\n  Enter Category: ";
+    cin >> ws;
+    string name;
+    getline(cin, name);
+    int partition = findCategoryPartition(name);
+    if(partition < 0) {
+        cout << "\n  Unknown category: " << name << "\n";
+        pauseScreen();
+    }
+    return partition;
+}
+
+void categorySearch() {
+    clearScreen();
+    const ScanKernels& kernels = activeScanKernels();
+    
+    cout << "\n============================================================\n";
+    cout << "               SEARCH WITHIN CATEGORY                      \n";
+    cout << "============================================================\n";
+    int p = promptCategoryPartition();
+    if(p < 0) {
+        return;
+    }
+    int searchOrderID;
+    string searchName;
+    cout << "  Enter Order ID: ";
+    cin >> searchOrderID;
+    cin.ignore();
+    cout << "  Enter Customer Name: ";
+    getline(cin, searchName);
+    
+    const CategoryPartition& partition = getCategoryPartitions().partitions[p];
+    ScopedTimer timer(TIMER_CATEGORY_SEARCH);
+    SearchResult result = columnSearchIn(partition.columns, kernels, searchOrderID, searchName);
+    double executionTime = timer.stop();
+    countStat(STAT_COMPARISONS, result.order ? result.position : (long long)partition.columns.rows.size());
     
     cout << "\n  ============================================================\n";
-    if(found) {
+    cout << "  Category: " << partition.name << " (" << partition.columns.rows.size()
+         << " of " << orderCount << " orders scanned at most)\n";
+    if(result.order != nullptr) {
         cout << "  Status: FOUND\n";
-        cout << "  Position: " << (i + 1) << "\n";
+        cout << "  Position in Category: " << result.position << "\n";
         cout << "  ------------------------------------------------------------\n";
-        cout << "  Order ID: " << tempArr[i]->orderID << "\n";
-        cout << "  Customer: " << tempArr[i]->customerName << "\n";
-        cout << "  Phone: " << tempArr[i]->phoneNumber << "\n";
-        cout << "  Product: " << tempArr[i]->productName << "\n";
-        cout << "  Category: " << tempArr[i]->productCategory << "\n";
-        cout << "  Total Amount: RM " << fixed << setprecision(2) << tempArr[i]->totalAmount << "\n";
+        cout << "  Order ID: " << result.order->orderID << "\n";
+        cout << "  Customer: " << result.order->customerName << "\n";
+        cout << "  Phone: " << result.order->phoneNumber << "\n";
+        cout << "  Product: " << result.order->productName << "\n";
+        cout << "  Total Amount: RM " << formatMoney(result.order->totalAmount) << "\n";
     } else {
         cout << "  Status: NOT FOUND\n";
     }
     cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
-    cout << "  Improvement: Sentinel technique eliminates boundary checking\n";
     cout << "  ============================================================\n";
+    pauseScreen();
+}
+
+// Quick sorts a copy of one category's rows; the main list is untouched
+void categorySort() {
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "                SORT WITHIN CATEGORY                       \n";
+    cout << "============================================================\n";
+    int p = promptCategoryPartition();
+    if(p < 0) {
+        return;
+    }
+    const CategoryPartition& partition = getCategoryPartitions().partitions[p];
+    vector<Order*> rows = partition.columns.rows;
+    int n = (int)rows.size();
     
-    delete[] arr;
-    delete[] tempArr;
-    pause();
+    long long swapCount = 0;
+    ScopedTimer timer(TIMER_CATEGORY_SORT);
+    if(n > 1) {
+        quickSortRecursive(&rows[0], 0, n - 1, swapCount);
+    }
+    double executionTime = timer.stop();
+    countStat(STAT_SWAPS, swapCount);
+    
+    clearScreen();
+    TableRenderer out;
+    int count = min(n, DISPLAY_LIMIT);
+    rendererReserve(out, (size_t)(count + 8) * TABLE_ROW_WIDTH);
+    rendererText(out, "\n  SORTED ");
+    rendererText(out, partition.name.c_str());
+    rendererText(out, " ORDERS (First ");
+    rendererInt(out, count, 0);
+    rendererText(out, ")\n");
+    renderOrderTableHeader(out);
+    for(int i = 0; i < count; i++) {
+        renderOrderRow(out, rows[i], i + 1);
+    }
+    rendererText(out, TABLE_RULE);
+    rendererFlush(out);
+    
+    cout << "  Category Orders: " << n << " of " << orderCount
+         << "  |  Sales: RM " << formatNumber(partition.salesSum)
+         << "  |  Quantity: " << partition.quantitySum << "\n";
+    cout << "  Largest Order: RM " << formatNumber(partition.maxAmount)
+         << "  |  Smallest Order: RM " << formatNumber(partition.minAmount) << "\n";
+    cout << "  Number of Swaps: " << swapCount << "\n";
+    cout << "  Execution Time: " << fixed << setprecision(4) << executionTime << " ms\n";
+    pauseScreen();
+}
+
+// ---------------------------------------------------------------------
+// Instrumentation
+// ---------------------------------------------------------------------
+
+void countStat(StatCounter counter, long long amount) {
+    statCounters[counter].fetch_add(amount, memory_order_relaxed);
+}
+
+#ifdef __linux__
+
+// Opens cycles, cache-miss and branch-miss counters for the calling thread
+// as one group so they can be read with a single read() call. Reads from
+// any other thread fail: they would report this thread's counts.
+bool openHardwareCounters() {
+    HardwareCounters& hw = hardwareCounters;
+    if(hw.available) {
+        return true;
+    }
+    const unsigned long long configs[HW_EVENT_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for(int e = 0; e < HW_EVENT_COUNT; e++) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[e];
+        attr.read_format = PERF_FORMAT_GROUP;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, (e == 0) ? -1 : hw.leaderFd, 0);
+        if(fd < 0) {
+            hw.error = string("perf_event_open failed: ") + strerror(errno);
+            for(int k = 0; k < e; k++) {
+                close(hw.fds[k]);
+            }
+            hw.leaderFd = -1;
+            return false;
+        }
+        hw.fds[e] = fd;
+        if(e == 0) {
+            hw.leaderFd = fd;
+        }
+    }
+    hw.owner = this_thread::get_id();
+    hw.error.clear();
+    hw.available = true;
+    return true;
+}
+
+bool readHardwareCounters(long long values[HW_EVENT_COUNT]) {
+    HardwareCounters& hw = hardwareCounters;
+    unsigned long long buffer[1 + HW_EVENT_COUNT];
+    if(!hw.available || this_thread::get_id() != hw.owner ||
+       read(hw.leaderFd, buffer, sizeof(buffer)) != (ssize_t)sizeof(buffer)) {
+        return false;
+    }
+    for(int e = 0; e < HW_EVENT_COUNT; e++) {
+        values[e] = (long long)buffer[1 + e];
+    }
+    return true;
+}
+
+#else
+
+bool openHardwareCounters() {
+    hardwareCounters.error = "hardware counters need Linux perf_event_open";
+    return false;
+}
+
+bool readHardwareCounters(long long[HW_EVENT_COUNT]) {
+    return false;
+}
+
+#endif
+
+void recordTimer(StatTimer timer, long long nanos) {
+    TimerStats& stats = statTimers[timer];
+    stats.calls++;
+    stats.totalNanos += nanos;
+    long long previous = stats.maxNanos;
+    while(nanos > previous && !stats.maxNanos.compare_exchange_weak(previous, nanos)) {
+    }
+}
+
+ScopedTimer::ScopedTimer(StatTimer id) : timer(id), readHardware(false), stopped(false), elapsedMs(0) {
+    if(hardwareCounters.enabled) {
+        readHardware = readHardwareCounters(hardwareStart);
+    }
+    start = high_resolution_clock::now();
+}
+
+ScopedTimer::~ScopedTimer() {
+    stop();
+}
+
+double ScopedTimer::stop() {
+    if(stopped) {
+        return elapsedMs;
+    }
+    auto end = high_resolution_clock::now();
+    stopped = true;
+    long long nanos = duration_cast<nanoseconds>(end - start).count();
+    elapsedMs = nanos / 1000000.0;
+    
+    recordTimer(timer, nanos);
+    
+    TimerStats& stats = statTimers[timer];
+    long long hardwareEnd[HW_EVENT_COUNT];
+    if(readHardware && readHardwareCounters(hardwareEnd)) {
+        for(int e = 0; e < HW_EVENT_COUNT; e++) {
+            stats.hardware[e] += hardwareEnd[e] - hardwareStart[e];
+        }
+    }
+    return elapsedMs;
+}
+
+void resetStats() {
+    for(int c = 0; c < STAT_COUNTER_COUNT; c++) {
+        statCounters[c] = 0;
+    }
+    for(int t = 0; t < TIMER_COUNT; t++) {
+        statTimers[t].calls = 0;
+        statTimers[t].totalNanos = 0;
+        statTimers[t].maxNanos = 0;
+        for(int e = 0; e < HW_EVENT_COUNT; e++) {
+            statTimers[t].hardware[e] = 0;
+        }
+    }
+}
+
+void displayStats() {
+    clearScreen();
+    cout << "\n============================================================\n";
+    cout << "                    COUNTERS & TIMERS                      \n";
+    cout << "============================================================\n";
+    for(int c = 0; c < STAT_COUNTER_COUNT; c++) {
+        cout << "  " << setw(22) << left << STAT_COUNTER_NAMES[c]
+             << setw(16) << right << statCounters[c].load() << "\n";
+    }
+    
+    bool showHardware = hardwareCounters.available;
+    cout << "\n  +----------------------+--------+------------+------------+";
+    if(showHardware) cout << "--------------+--------------+--------------+";
+    cout << "\n  | Timer                | Calls  | Total (ms) | Max (ms)   |";
+    if(showHardware) cout << " Cycles       | Cache Misses | Branch Miss  |";
+    cout << "\n  +----------------------+--------+------------+------------+";
+    if(showHardware) cout << "--------------+--------------+--------------+";
+    cout << "\n";
+    for(int t = 0; t < TIMER_COUNT; t++) {
+        TimerStats& stats = statTimers[t];
+        if(stats.calls == 0) continue;
+        cout << "  | " << setw(20) << left << STAT_TIMER_NAMES[t]
+             << " | " << setw(6) << right << stats.calls.load()
+             << " | " << setw(10) << fixed << setprecision(3) << stats.totalNanos / 1000000.0
+             << " | " << setw(10) << stats.maxNanos / 1000000.0 << " |";
+        if(showHardware) {
+            for(int e = 0; e < HW_EVENT_COUNT; e++) {
+                cout << " " << setw(12) << stats.hardware[e].load() << " |";
+            }
+        }
+        cout << "\n";
+    }
+    cout << "  +----------------------+--------+------------+------------+";
+    if(showHardware) cout << "--------------+--------------+--------------+";
+    cout << "\n";
+    
+    cout << "\n  Hardware counters: ";
+    if(!hardwareCounters.enabled) {
+        cout << "off\n";
+    } else if(hardwareCounters.available) {
+        cout << "on (menu thread only)\n";
+    } else {
+        cout << "unavailable - " << hardwareCounters.error << "\n";
+    }
+    pauseScreen();
+}
+
+bool dumpStatsJson(const string& path) {
+    ofstream file(path.c_str());
+    if(!file) {
+        return false;
+    }
+    file << "{\n  \"counters\": {\n";
+    for(int c = 0; c < STAT_COUNTER_COUNT; c++) {
+        file << "    \"" << STAT_COUNTER_NAMES[c] << "\": " << statCounters[c].load()
+             << (c + 1 < STAT_COUNTER_COUNT ? ",\n" : "\n");
+    }
+    file << "  },\n  \"hardware_counters\": " << (hardwareCounters.available ? "true" : "false") << ",\n";
+    file << "  \"timers\": {\n";
+    for(int t = 0; t < TIMER_COUNT; t++) {
+        TimerStats& stats = statTimers[t];
+        file << "    \"" << STAT_TIMER_NAMES[t] << "\": {\"calls\": " << stats.calls.load()
+             << ", \"total_ms\": " << fixed << setprecision(6) << stats.totalNanos / 1000000.0
+             << ", \"max_ms\": " << stats.maxNanos / 1000000.0;
+        if(hardwareCounters.available) {
+            for(int e = 0; e < HW_EVENT_COUNT; e++) {
+                file << ", \"" << HW_EVENT_NAMES[e] << "\": " << stats.hardware[e].load();
+            }
+        }
+        file << "}" << (t + 1 < TIMER_COUNT ? ",\n" : "\n");
+    }
+    file << "  }\n}\n";
+    return true;
+}
+
+void statsMenu() {
+    int choice;
+    do {
+        clearScreen();
+        cout << "\n============================================================\n";
+        cout << "                        STATS MENU                         \n";
+        cout << "============================================================\n";
+        cout << "  [1] View Counters & Timers\n";
+        cout << "  [2] Thread Pool Status\n";
+        cout << "  [3] Toggle Hardware Counters (currently "
+             << (hardwareCounters.enabled ? "ON" : "OFF") << ")\n";
+        cout << "  [4] Dump Stats to osoms_stats.json\n";
+        cout << "  [5] Reset Counters & Timers\n";
+        cout << "  [0] Back to Main Menu\n";
+        cout << "============================================================\n";
+        cout << "  Enter choice: ";
+        cin >> choice;
+        
+        switch(choice) {
+            case 1: displayStats(); break;
+            case 2: taskSchedulerStatus(); break;
+            case 3:
+                hardwareCounters.enabled = !hardwareCounters.enabled;
+                if(hardwareCounters.enabled && !openHardwareCounters()) {
+                    cout << "\n  " << hardwareCounters.error << "\n";
+                    cout << "  Timers will keep working without hardware events.\n";
+                    pauseScreen();
+                }
+                break;
+            case 4:
+                if(dumpStatsJson("osoms_stats.json")) {
+                    cout << "\n  Stats written to osoms_stats.json\n";
+                } else {
+                    cout << "\n  Error creating file!\n";
+                }
+                pauseScreen();
+                break;
+            case 5: resetStats(); break;
+            case 0: break;
+            default: cout << "\n  Invalid choice!\n"; pauseScreen();
+        }
+    } while(choice != 0);
+}
+
+// ---------------------------------------------------------------------
+// Query server
+// ---------------------------------------------------------------------
+//
+// Readers take a reference to the current immutable ServerSnapshot and
+// never wait on the writer. A single writer thread applies queued
+// mutations to a private copy and publishes it as the next version
+// (RCU style: old versions are freed when their last reader lets go).
+//
+// Protocol: one request per line, one response line per request.
+//   PING
+//   GET <orderID> <customer name>
+//   RANGE <amount|price|qty> <min> <max> [limit]
+//   REPORT <total|category>
+//   ADD <id|name|phone|product|category|qty|price|total>
+//   DEL <orderID> <customer name>
+//   STATS
+//   QUIT | SHUTDOWN
+
+#ifndef _WIN32
+
+struct ServerSnapshot {
+    long long version;
+    vector<Order> orders;
+    vector<Order*> byID;              // sorted by orderID
+    RangeIndex ranges[RANGE_COLUMN_COUNT];
+    Money totalSales;
+    vector<pair<string, pair<int, Money> > > categories;  // name -> (orders, sales)
+};
+
+struct ServerMutation {
+    bool isAdd;
+    Order order;                      // for ADD
+    int orderID;                      // for DEL
+    string customerName;              // for DEL
+    promise<string> reply;
+};
+
+shared_ptr<const ServerSnapshot> serverSnapshot;
+mutex serverWriterMutex;
+condition_variable serverWriterWake;
+deque<ServerMutation*> serverWriterQueue;
+atomic<bool> serverStopping(false);
+atomic<long long> serverRequests(0);
+atomic<int> serverActiveClients(0);
+int serverListenFd = -1;
+mutex serverClientsMutex;
+vector<int> serverClientFds;          // open client sockets, shut down on stop
+
+bool compareOrderIDs(const Order* a, const Order* b) {
+    return a->orderID < b->orderID;
+}
+
+shared_ptr<const ServerSnapshot> buildServerSnapshot(vector<Order>& orders, long long version) {
+    shared_ptr<ServerSnapshot> snap = make_shared<ServerSnapshot>();
+    snap->version = version;
+    snap->orders.swap(orders);
+    
+    vector<Order*> rows;
+    rows.reserve(snap->orders.size());
+    snap->totalSales = 0;
+    vector<pair<string, pair<int, Money> > >& categories = snap->categories;
+    for(size_t i = 0; i < snap->orders.size(); i++) {
+        Order* order = &snap->orders[i];
+        order->next = nullptr;
+        rows.push_back(order);
+        snap->totalSales += order->totalAmount;
+        
+        size_t c = 0;
+        while(c < categories.size() && categories[c].first != order->productCategory) {
+            c++;
+        }
+        if(c == categories.size()) {
+            categories.push_back(make_pair(order->productCategory, make_pair(0, (Money)0)));
+        }
+        categories[c].second.first++;
+        categories[c].second.second += order->totalAmount;
+    }
+    
+    snap->byID = rows;
+    sort(snap->byID.begin(), snap->byID.end(), compareOrderIDs);
+    for(int c = 0; c < RANGE_COLUMN_COUNT; c++) {
+        buildRangeIndex(snap->ranges[c], rows, (RangeColumn)c);
+    }
+    return snap;
+}
+
+string formatOrderLine(const Order* order) {
+    stringstream ss;
+    ss << order->orderID << "|" << order->customerName << "|" << order->phoneNumber << "|"
+       << order->productName << "|" << order->productCategory << "|" << order->quantity << "|"
+       << formatMoney(order->unitPrice) << "|" << formatMoney(order->totalAmount);
+    return ss.str();
+}
+
+const Order* findInSnapshot(const ServerSnapshot& snap, int orderID, const string& customerName) {
+    Order probe;
+    probe.orderID = orderID;
+    vector<Order*>::const_iterator it = lower_bound(snap.byID.begin(), snap.byID.end(), &probe, compareOrderIDs);
+    for(; it != snap.byID.end() && (*it)->orderID == orderID; ++it) {
+        if((*it)->customerName == customerName) {
+            return *it;
+        }
+    }
+    return nullptr;
+}
+
+void serverWriterLoop() {
+    while(true) {
+        deque<ServerMutation*> batch;
+        {
+            unique_lock<mutex> lock(serverWriterMutex);
+            while(serverWriterQueue.empty() && !serverStopping) {
+                serverWriterWake.wait(lock);
+            }
+            if(serverWriterQueue.empty()) {
+                return;
+            }
+            batch.swap(serverWriterQueue);
+        }
+        
+        // Copy-on-write: the published snapshot is never modified. Each batch
+        // copies the orders and rebuilds the indexes, O(n log n) per batch
+        // however many mutations it holds; writers queued together share it.
+        shared_ptr<const ServerSnapshot> current = atomic_load(&serverSnapshot);
+        vector<Order> orders = current->orders;
+        long long version = current->version + 1;
+        vector<string> replies;
+        
+        // Deletes of rows from the current snapshot are found through its ID
+        // index and marked; rows added earlier in this batch are searched
+        vector<char> deleted(orders.size(), 0);
+        size_t carried = orders.size();
+        for(size_t m = 0; m < batch.size(); m++) {
+            ServerMutation* mutation = batch[m];
+            if(mutation->isAdd) {
+                orders.push_back(mutation->order);
+                deleted.push_back(0);
+                replies.push_back("OK");
+                continue;
+            }
+            size_t found = orders.size();
+            Order probe;
+            probe.orderID = mutation->orderID;
+            vector<Order*>::const_iterator it = lower_bound(current->byID.begin(), current->byID.end(),
+                                                            &probe, compareOrderIDs);
+            for(; it != current->byID.end() && (*it)->orderID == mutation->orderID && found == orders.size(); ++it) {
+                size_t i = *it - &current->orders[0];
+                if(!deleted[i] && (*it)->customerName == mutation->customerName) {
+                    found = i;
+                }
+            }
+            for(size_t i = carried; i < orders.size() && found == orders.size(); i++) {
+                if(!deleted[i] && orders[i].orderID == mutation->orderID &&
+                   orders[i].customerName == mutation->customerName) {
+                    found = i;
+                }
+            }
+            if(found < orders.size()) {
+                deleted[found] = 1;
+                replies.push_back("OK");
+            } else {
+                replies.push_back("NOTFOUND");
+            }
+        }
+        size_t kept = 0;
+        for(size_t i = 0; i < orders.size(); i++) {
+            if(!deleted[i]) {
+                if(kept != i) {
+                    orders[kept] = orders[i];
+                }
+                kept++;
+            }
+        }
+        orders.resize(kept);
+        
+        atomic_store(&serverSnapshot, buildServerSnapshot(orders, version));
+        
+        // Replies go out only after publishing, so clients read their own writes
+        for(size_t m = 0; m < batch.size(); m++) {
+            if(replies[m] == "OK") {
+                replies[m] += " version=" + to_string(version);
+            }
+            batch[m]->reply.set_value(replies[m]);
+        }
+    }
 }
 
+string submitServerMutation(ServerMutation* mutation) {
+    future<string> reply = mutation->reply.get_future();
+    {
+        // Checked under the queue lock: the writer only exits once it has
+        // seen serverStopping with the queue empty, so nothing queued after
+        // that would ever be answered
+        lock_guard<mutex> lock(serverWriterMutex);
+        if(serverStopping) {
+            delete mutation;
+            return "ERR server is shutting down";
+        }
+        serverWriterQueue.push_back(mutation);
+    }
+    serverWriterWake.notify_one();
+    string result = reply.get();
+    delete mutation;
+    return result;
+}
 
+RangeColumn parseRangeColumn(const string& name, bool& ok) {
+    ok = true;
+    if(name == "amount") return RANGE_TOTAL_AMOUNT;
+    if(name == "price") return RANGE_UNIT_PRICE;
+    if(name == "qty") return RANGE_QUANTITY;
+    ok = false;
+    return RANGE_TOTAL_AMOUNT;
+}
 
-void calculateTotalSales() {
-    clearScreen();
-    cout << "\n============================================================\n";
-    cout << "                 TOTAL SALES REPORT                        \n";
-    cout << "============================================================\n\n";
-    
-    double totalSales = 0;
-    int totalOrders = 0;
-    
-    Order* current = orderList;
-    while(current != nullptr) {
-        totalSales += current->totalAmount;
-        totalOrders++;
-        current = current->next;
-    }
-    
-    cout << "  +------------------------------------------------------------+\n";
-    cout << "  | Sales Summary                                              |\n";
-    cout << "  +------------------------------------------------------------+\n";
-    cout << "  | Total Orders:   " << setw(6) << totalOrders << " orders                             |\n";
-    cout << "  | Total Sales:    RM " << setw(18) << right << formatNumber(totalSales) << "                   |\n";
-    cout << "  +------------------------------------------------------------+\n";
-    
-    pause();
+string restOfLine(istringstream& in) {
+    string rest;
+    getline(in, rest);
+    size_t begin = rest.find_first_not_of(' ');
+    return (begin == string::npos) ? "" : rest.substr(begin);
 }
 
-void totalQuantitySold() {
-    clearScreen();
-    cout << "\n============================================================\n";
-    cout << "          TOTAL QUANTITY SOLD (BY PRODUCT)                \n";
-    cout << "============================================================\n\n";
+string handleServerRequest(const string& line) {
+    istringstream in(line);
+    string command;
+    in >> command;
+    serverRequests++;
     
-    struct ProductData {
-        string name;
-        int totalQuantity;
-    };
+    if(command == "PING") {
+        return "OK PONG";
+    }
     
-    ProductData products[50];
-    int productCount = 0;
+    if(command == "GET") {
+        int orderID;
+        if(!(in >> orderID)) return "ERR usage: GET <orderID> <customer name>";
+        string name = restOfLine(in);
+        shared_ptr<const ServerSnapshot> snap = atomic_load(&serverSnapshot);
+        const Order* order = findInSnapshot(*snap, orderID, name);
+        return order ? "OK " + formatOrderLine(order) : "NOTFOUND";
+    }
     
-    // Aggregate quantities by product
-    Order* current = orderList;
-    while(current != nullptr) {
-        bool found = false;
-        for(int i = 0; i < productCount; i++) {
-            if(products[i].name == current->productName) {
-                products[i].totalQuantity += current->quantity;
-                found = true;
-                break;
-            }
+    if(command == "RANGE") {
+        string columnName;
+        double minValue, maxValue;
+        size_t limit = 10;
+        if(!(in >> columnName >> minValue >> maxValue)) {
+            return "ERR usage: RANGE <amount|price|qty> <min> <max> [limit]";
+        }
+        in >> limit;
+        bool ok;
+        RangeColumn column = parseRangeColumn(columnName, ok);
+        if(!ok) return "ERR unknown column " + columnName;
+        if(!moneyInputInRange(minValue) || !moneyInputInRange(maxValue)) {
+            return "ERR bound out of range";
         }
         
-        if(!found && productCount < 50) {
-            products[productCount].name = current->productName;
-            products[productCount].totalQuantity = current->quantity;
-            productCount++;
+        shared_ptr<const ServerSnapshot> snap = atomic_load(&serverSnapshot);
+        const RangeIndex& index = snap->ranges[column];
+        size_t first, last;
+        findRangeBounds(index, rangeInputKey(column, minValue, false), rangeInputKey(column, maxValue, true), first, last);
+        long long keySum = index.keyPrefix[last] - index.keyPrefix[first];
+        stringstream out;
+        out << "OK count=" << (last - first)
+            << " sum=" << (column == RANGE_QUANTITY ? to_string(keySum) : formatMoney(keySum))
+            << " amount=" << formatMoney(index.amountPrefix[last] - index.amountPrefix[first]) << " ids=";
+        for(size_t i = first; i < last && i < first + limit; i++) {
+            out << (i > first ? "," : "") << index.rows[i]->orderID;
         }
-        current = current->next;
+        return out.str();
     }
     
-    // Sort by quantity (descending)
-    for(int i = 0; i < productCount - 1; i++) {
-        for(int j = 0; j < productCount - i - 1; j++) {
-            if(products[j].totalQuantity < products[j + 1].totalQuantity) {
-                ProductData temp = products[j];
-                products[j] = products[j + 1];
-                products[j + 1] = temp;
+    if(command == "REPORT") {
+        string kind;
+        in >> kind;
+        shared_ptr<const ServerSnapshot> snap = atomic_load(&serverSnapshot);
+        stringstream out;
+        if(kind == "total") {
+            out << "OK orders=" << snap->orders.size() << " sales=" << formatMoney(snap->totalSales);
+        } else if(kind == "category") {
+            out << "OK";
+            for(size_t c = 0; c < snap->categories.size(); c++) {
+                out << " " << snap->categories[c].first << ":" << snap->categories[c].second.first
+                    << ":" << formatMoney(snap->categories[c].second.second);
             }
+        } else {
+            return "ERR usage: REPORT <total|category>";
         }
+        return out.str();
     }
     
-    cout << "  +----+-------------------------+------------------+\n";
-    cout << "  | No | Product Name            | Total Quantity   |\n";
-    cout << "  +----+-------------------------+------------------+\n";
-    
-    // Show highest selling product
-    if(productCount > 0) {
-        cout << "  | " << setw(2) << 1
-             << " | " << setw(23) << left << products[0].name.substr(0, 23)
-             << " | " << setw(16) << right << products[0].totalQuantity << " |\n";
+    if(command == "ADD") {
+        ServerMutation* mutation = new ServerMutation();
+        mutation->isAdd = true;
+        if(!parseOrderLine(restOfLine(in), &mutation->order)) {
+            delete mutation;
+            return "ERR malformed order line";
+        }
+        return submitServerMutation(mutation);
     }
     
-    // Show lowest selling product
-    if(productCount > 1) {
-        cout << "  | " << setw(2) << productCount
-             << " | " << setw(23) << left << products[productCount - 1].name.substr(0, 23)
-             << " | " << setw(16) << right << products[productCount - 1].totalQuantity << " |\n";
+    if(command == "DEL") {
+        ServerMutation* mutation = new ServerMutation();
+        mutation->isAdd = false;
+        if(!(in >> mutation->orderID)) {
+            delete mutation;
+            return "ERR usage: DEL <orderID> <customer name>";
+        }
+        mutation->customerName = restOfLine(in);
+        return submitServerMutation(mutation);
     }
     
-    cout << "  +----+-------------------------+------------------+\n";
-    cout << "\n  Note: Showing highest and lowest selling products only.\n";
-    cout << "        Total products tracked: " << productCount << "\n";
+    if(command == "STATS") {
+        shared_ptr<const ServerSnapshot> snap = atomic_load(&serverSnapshot);
+        stringstream out;
+        out << "OK version=" << snap->version << " orders=" << snap->orders.size()
+            << " requests=" << serverRequests.load() << " clients=" << serverActiveClients.load();
+        return out.str();
+    }
     
-    pause();
+    return "ERR unknown command";
 }
 
-
-void salesByCategory() {
-    clearScreen();
-    cout << "\n============================================================\n";
-    cout << "            SALES ANALYSIS BY CATEGORY                     \n";
-    cout << "============================================================\n\n";
-    
-    // Only include categories that are actually used in the data
-    struct CategoryData {
-        string name;
-        int orderCount;
-        double totalSales;
-    };
+// Buffered line reader over a socket
+struct SocketLineReader {
+    int fd;
+    char buffer[4096];
+    size_t length;
+    size_t position;
     
-    CategoryData categories[6] = {
-        {"Food", 0, 0.0},
-        {"Clothing", 0, 0.0},
-        {"Books", 0, 0.0},
-        {"Toys", 0, 0.0},
-        {"Sports", 0, 0.0},
-        {"Beauty", 0, 0.0}
-    };
+    SocketLineReader(int socketFd) : fd(socketFd), length(0), position(0) {}
     
-    int totalOrders = 0;
-    Order* current = orderList;
-    while(current != nullptr) {
-        for(int i = 0; i < 6; i++) {
-            if(current->productCategory == categories[i].name) {
-                categories[i].totalSales += current->totalAmount;
-                categories[i].orderCount++;
-                totalOrders++;
-                break;
+    bool readLine(string& line) {
+        line.clear();
+        while(true) {
+            while(position < length) {
+                char c = buffer[position++];
+                if(c == '\n') {
+                    if(!line.empty() && line[line.size() - 1] == '\r') {
+                        line.erase(line.size() - 1);
+                    }
+                    return true;
+                }
+                line += c;
+            }
+            ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+            if(received <= 0) {
+                return false;
             }
+            length = (size_t)received;
+            position = 0;
         }
-        current = current->next;
     }
-    
-    // Sort by order count (descending - most orders first)
-    for(int i = 0; i < 5; i++) {
-        for(int j = 0; j < 5 - i; j++) {
-            if(categories[j].orderCount < categories[j + 1].orderCount) {
-                CategoryData temp = categories[j];
-                categories[j] = categories[j + 1];
-                categories[j + 1] = temp;
-            }
+};
+
+bool sendAll(int fd, const string& data) {
+    size_t sent = 0;
+    while(sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if(n <= 0) {
+            return false;
         }
+        sent += (size_t)n;
     }
-    
-    cout << "  +-----------------+------------+------------------+--------------+\n";
-    cout << "  | Category        | Orders     | Total Sales (RM) | Percentage % |\n";
-    cout << "  +-----------------+------------+------------------+--------------+\n";
-    
-    for(int i = 0; i < 6; i++) {
-        double percentage = (totalOrders > 0) ? (categories[i].orderCount * 100.0 / totalOrders) : 0.0;
-        cout << "  | " << setw(15) << left << categories[i].name 
-             << " | " << setw(10) << right << categories[i].orderCount
-             << " | " << setw(16) << right << formatNumber(categories[i].totalSales)
-             << " | " << setw(12) << fixed << setprecision(2) << percentage << " |\n";
+    return true;
+}
+
+bool isTcpEndpoint(const string& endpoint) {
+    return !endpoint.empty() && endpoint.find_first_not_of("0123456789") == string::npos;
+}
+
+// Opens a listening socket: a numeric endpoint is a localhost TCP port,
+// anything else is a Unix domain socket path
+int openServerSocket(const string& endpoint) {
+    int fd;
+    if(isTcpEndpoint(endpoint)) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if(fd < 0) return -1;
+        int yes = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)atoi(endpoint.c_str()));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if(::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(fd < 0) return -1;
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, endpoint.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(endpoint.c_str());
+        if(::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
     }
-    
-    // Calculate grand total sales
-    double grandTotal = 0.0;
-    for(int i = 0; i < 6; i++) {
-        grandTotal += categories[i].totalSales;
+    if(listen(fd, 128) < 0) {
+        close(fd);
+        return -1;
     }
-    
-    cout << "  +-----------------+------------+------------------+--------------+\n";
-    cout << "  | TOTAL           | " << setw(10) << right << totalOrders 
-         << " | " << setw(16) << right << formatNumber(grandTotal) << " | " << setw(12) << "100.00" << " |\n";
-    cout << "  +-----------------+------------+------------------+--------------+\n";
-    
-    pause();
+    return fd;
 }
 
-void topCustomers() {
-    clearScreen();
-    cout << "\n============================================================\n";
-    cout << "              TOP 10 CUSTOMERS BY SPENDING                 \n";
-    cout << "============================================================\n\n";
+int connectToServer(const string& endpoint) {
+    int fd;
+    if(isTcpEndpoint(endpoint)) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if(fd < 0) return -1;
+        int yes = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)atoi(endpoint.c_str()));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if(connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+    } else {
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(fd < 0) return -1;
+        sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, endpoint.c_str(), sizeof(addr.sun_path) - 1);
+        if(connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    return fd;
+}
+
+void serveClient(int clientFd) {
+    serverActiveClients++;
+    {
+        lock_guard<mutex> lock(serverClientsMutex);
+        if(serverStopping) {
+            close(clientFd);
+            serverActiveClients--;
+            return;
+        }
+        serverClientFds.push_back(clientFd);
+    }
+    SocketLineReader reader(clientFd);
+    string line;
+    while(reader.readLine(line)) {
+        if(line == "QUIT") {
+            break;
+        }
+        if(line == "SHUTDOWN") {
+            sendAll(clientFd, "OK BYE\n");
+            serverStopping = true;
+            shutdown(serverListenFd, SHUT_RDWR);
+            break;
+        }
+        if(!sendAll(clientFd, handleServerRequest(line) + "\n")) {
+            break;
+        }
+    }
+    {
+        lock_guard<mutex> lock(serverClientsMutex);
+        serverClientFds.erase(find(serverClientFds.begin(), serverClientFds.end(), clientFd));
+        close(clientFd);
+    }
+    serverActiveClients--;
+}
+
+void runServer(const string& endpoint) {
+    vector<Order> orders;
+    orders.reserve(orderCount);
+    for(Order* current = orderList; current != nullptr; current = current->next) {
+        orders.push_back(*current);
+    }
+    atomic_store(&serverSnapshot, buildServerSnapshot(orders, 1));
     
-    struct CustomerSpending {
-        string customerName;
-        double totalSpending;
-        int orderCount;
-    };
+    serverListenFd = openServerSocket(endpoint);
+    if(serverListenFd < 0) {
+        cout << "  Error: cannot listen on " << endpoint << " (" << strerror(errno) << ")\n";
+        return;
+    }
     
-    CustomerSpending customers[2000];
-    int uniqueCustomers = 0;
+    cout << "\n============================================================\n";
+    cout << "                     OSOMS QUERY SERVER                    \n";
+    cout << "============================================================\n";
+    cout << "  Endpoint: " << (isTcpEndpoint(endpoint) ? "127.0.0.1:" : "unix:") << endpoint << "\n";
+    cout << "  Orders in snapshot: " << orderCount << "\n";
+    cout << "  Send SHUTDOWN from any client to stop.\n";
+    cout << "============================================================\n";
     
-    Order* current = orderList;
-    while(current != nullptr) {
-        bool found = false;
-        for(int i = 0; i < uniqueCustomers; i++) {
-            if(customers[i].customerName == current->customerName) {
-                customers[i].totalSpending += current->totalAmount;
-                customers[i].orderCount++;
-                found = true;
-                break;
-            }
+    thread writer(serverWriterLoop);
+    while(!serverStopping) {
+        int clientFd = accept(serverListenFd, nullptr, nullptr);
+        if(clientFd < 0) {
+            if(errno == EINTR) continue;
+            break;
         }
-        
-        if(!found && uniqueCustomers < 2000) {
-            customers[uniqueCustomers].customerName = current->customerName;
-            customers[uniqueCustomers].totalSpending = current->totalAmount;
-            customers[uniqueCustomers].orderCount = 1;
-            uniqueCustomers++;
+        if(isTcpEndpoint(endpoint)) {
+            int yes = 1;
+            setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
         }
-        current = current->next;
+        thread(serveClient, clientFd).detach();
     }
     
-    for(int i = 0; i < uniqueCustomers - 1; i++) {
-        for(int j = 0; j < uniqueCustomers - i - 1; j++) {
-            if(customers[j].totalSpending < customers[j + 1].totalSpending) {
-                CustomerSpending temp = customers[j];
-                customers[j] = customers[j + 1];
-                customers[j + 1] = temp;
+    serverStopping = true;
+    serverWriterWake.notify_all();
+    writer.join();
+    close(serverListenFd);
+    if(!isTcpEndpoint(endpoint)) {
+        unlink(endpoint.c_str());
+    }
+    // Wake clients blocked in recv, idle ones included; their threads see
+    // end of stream and close their own sockets
+    {
+        lock_guard<mutex> lock(serverClientsMutex);
+        for(size_t c = 0; c < serverClientFds.size(); c++) {
+            shutdown(serverClientFds[c], SHUT_RDWR);
+        }
+    }
+    while(serverActiveClients > 0) {
+        this_thread::sleep_for(milliseconds(10));
+    }
+    cout << "  Server stopped after " << serverRequests.load() << " requests.\n";
+}
+
+struct LoadgenClientResult {
+    vector<long long> latencies;  // nanoseconds
+    long long errors;
+};
+
+void loadgenClient(const string& endpoint, int clientIndex, int requests, int writePercent,
+                   const vector<pair<int, string> >* keys, LoadgenClientResult* result) {
+    result->errors = 0;
+    result->latencies.reserve(requests);
+    int fd = connectToServer(endpoint);
+    if(fd < 0) {
+        result->errors = requests;
+        return;
+    }
+    SocketLineReader reader(fd);
+    mt19937 rng(1000 + clientIndex);
+    string reply;
+    int nextAddID = 900000000 + clientIndex * 1000000;
+    vector<int> addedIDs;
+    
+    for(int r = 0; r < requests; r++) {
+        int roll = (int)(rng() % 100);
+        stringstream request;
+        if(roll < writePercent) {
+            if(!addedIDs.empty() && (rng() & 1)) {
+                request << "DEL " << addedIDs.back() << " Loadgen Client";
+                addedIDs.pop_back();
+            } else {
+                request << "ADD " << nextAddID << "|Loadgen Client|000 0000000|Test Item|Loadgen|1|1.00|1.00";
+                addedIDs.push_back(nextAddID++);
             }
+        } else if(roll < 70) {
+            const pair<int, string>& key = (*keys)[rng() % keys->size()];
+            // Roughly one lookup in four is a miss, like a mistyped ID
+            int orderID = (rng() % 4 == 0) ? key.first + 7 : key.first;
+            request << "GET " << orderID << " " << key.second;
+        } else if(roll < 90) {
+            int low = (int)(rng() % 1500);
+            request << "RANGE amount " << low << " " << low + 100 << " 10";
+        } else {
+            request << ((rng() & 1) ? "REPORT total" : "REPORT category");
         }
+        request << "\n";
+        
+        auto start = high_resolution_clock::now();
+        if(!sendAll(fd, request.str()) || !reader.readLine(reply)) {
+            result->errors += requests - r;
+            break;
+        }
+        auto end = high_resolution_clock::now();
+        if(reply.compare(0, 3, "ERR") == 0) {
+            result->errors++;
+        }
+        result->latencies.push_back(duration_cast<nanoseconds>(end - start).count());
+    }
+    sendAll(fd, "QUIT\n");
+    close(fd);
+}
+
+void runLoadGenerator(const string& endpoint, int clients, int requestsPerClient, int writePercent) {
+    vector<pair<int, string> > keys;
+    for(Order* current = orderList; current != nullptr; current = current->next) {
+        keys.push_back(make_pair(current->orderID, current->customerName));
+    }
+    if(keys.empty()) {
+        keys.push_back(make_pair(1, string("Nobody")));
     }
     
-    cout << "  +----+--------------------+--------+------------------+\n";
-    cout << "  | No | Customer Name      | Orders | Total Spent (RM) |\n";
-    cout << "  +----+--------------------+--------+------------------+\n";
+    cout << "\n============================================================\n";
+    cout << "                  OSOMS LOAD GENERATOR                     \n";
+    cout << "============================================================\n";
+    cout << "  Endpoint: " << endpoint << "\n";
+    cout << "  Clients: " << clients << "   Requests/client: " << requestsPerClient
+         << "   Writes: " << writePercent << "%\n";
     
-    int displayCount = (uniqueCustomers < 10) ? uniqueCustomers : 10;
-    for(int i = 0; i < displayCount; i++) {
-        cout << "  | " << setw(2) << (i + 1)
-             << " | " << setw(18) << left << customers[i].customerName.substr(0, 18)
-             << " | " << setw(6) << right << customers[i].orderCount
-             << " | " << setw(16) << fixed << setprecision(2) << customers[i].totalSpending << " |\n";
+    vector<LoadgenClientResult> results(clients);
+    vector<thread> workers;
+    auto start = high_resolution_clock::now();
+    for(int c = 0; c < clients; c++) {
+        workers.push_back(thread(loadgenClient, endpoint, c, requestsPerClient, writePercent, &keys, &results[c]));
+    }
+    for(size_t c = 0; c < workers.size(); c++) {
+        workers[c].join();
     }
+    auto end = high_resolution_clock::now();
+    double seconds = duration_cast<microseconds>(end - start).count() / 1000000.0;
     
-    cout << "  +----+--------------------+--------+------------------+\n";
+    vector<long long> all;
+    long long errors = 0;
+    for(int c = 0; c < clients; c++) {
+        all.insert(all.end(), results[c].latencies.begin(), results[c].latencies.end());
+        errors += results[c].errors;
+    }
+    sort(all.begin(), all.end());
     
-    pause();
+    cout << "------------------------------------------------------------\n";
+    cout << "  Completed Requests: " << all.size() << "   Errors: " << errors << "\n";
+    cout << "  Wall Time:          " << fixed << setprecision(3) << seconds << " s\n";
+    cout << "  Throughput:         " << setprecision(0) << (seconds > 0 ? all.size() / seconds : 0) << " req/s\n";
+    if(!all.empty()) {
+        const double percentiles[] = {50, 90, 99, 99.9};
+        const char* labels[] = {"p50  ", "p90  ", "p99  ", "p99.9"};
+        for(int p = 0; p < 4; p++) {
+            size_t rank = min(all.size() - 1, (size_t)(percentiles[p] / 100.0 * all.size()));
+            cout << "  " << labels[p] << " latency:    " << setprecision(1) << all[rank] / 1000.0 << " us\n";
+        }
+        cout << "  max   latency:    " << setprecision(1) << all.back() / 1000.0 << " us\n";
+    }
+    cout << "============================================================\n";
+}
+
+#else
+
+void runServer(const string& endpoint) {
+    cout << "  Server mode needs Unix sockets and is not available on Windows.\n";
+}
+
+void runLoadGenerator(const string& endpoint, int clients, int requestsPerClient, int writePercent) {
+    cout << "  Load generator needs Unix sockets and is not available on Windows.\n";
 }
 
+#endif
+
 void clearScreen() {
     #ifdef _WIN32
         system("cls");
@@ -975,7 +7154,7 @@ void clearScreen() {
     #endif
 }
 
-void pause() {
+void pauseScreen() {
     cout << "\n  Press Enter to continue...";
     cin.ignore();
     cin.get();
@@ -991,60 +7170,87 @@ void freeMemory() {
         delete temp;
     }
     orderList = nullptr;
+    orderTail = nullptr;
     orderCount = 0;
+    dataVersion++;
+    layoutVersion++;
 }
 
-void reloadData() {
-    // Free existing data
-    freeMemory();
-    
-    // Reload from file
-    ifstream file("orders_data.txt");
-    if(file.is_open()) {
-        string line;
-        while(getline(file, line)) {
-            Order* newOrder = new Order();
-            stringstream ss(line);
-            string temp;
-            
-            getline(ss, temp, '|'); newOrder->orderID = stoi(temp);
-            getline(ss, newOrder->customerName, '|');
-            getline(ss, newOrder->phoneNumber, '|');
-            getline(ss, newOrder->productName, '|');
-            getline(ss, newOrder->productCategory, '|');
-            getline(ss, temp, '|'); newOrder->quantity = stoi(temp);
-            getline(ss, temp, '|'); newOrder->unitPrice = stod(temp);
-            getline(ss, temp, '|'); newOrder->totalAmount = stod(temp);
-            
-            newOrder->next = orderList;
-            orderList = newOrder;
-            orderCount++;
-        }
-        file.close();
-    }
-}
-
-string formatNumber(double num) {
-    stringstream ss;
-    ss << fixed << setprecision(2) << num;
-    string numStr = ss.str();
-    
-    // Find decimal point
-    size_t decimalPos = numStr.find('.');
-    string intPart = (decimalPos != string::npos) ? numStr.substr(0, decimalPos) : numStr;
-    string decPart = (decimalPos != string::npos) ? numStr.substr(decimalPos) : "";
+// "1,234,567.50"
+string formatNumber(Money amount) {
+    char text[40];
+    int length = formatMoneyChars(amount, true, text);
+    return string(text, length);
+}
+
+// "1234567.50", as written to orders_data.txt
+string formatMoney(Money amount) {
+    char text[40];
+    int length = formatMoneyChars(amount, false, text);
+    return string(text, length);
+}
+
+// Parses "[-]digits[.digits]" into cents without going through floating
+// point; a third decimal rounds half away from zero. Surrounding blanks
+// (including a CR from Windows line endings) are ignored. Throws
+// invalid_argument on anything else and out_of_range past
+// LLONG_MAX / CENTS_PER_RINGGIT ringgit, like stod.
+Money parseMoney(const string& text) {
+    size_t i = 0, end = text.size();
+    while(i < end && isspace((unsigned char)text[i])) i++;
+    while(end > i && isspace((unsigned char)text[end - 1])) end--;
     
-    // Add commas to integer part
-    string result = "";
-    int count = 0;
-    for(int i = intPart.length() - 1; i >= 0; i--) {
-        if(count == 3) {
-            result = "," + result;
-            count = 0;
+    bool negative = false;
+    if(i < end && (text[i] == '-' || text[i] == '+')) {
+        negative = (text[i] == '-');
+        i++;
+    }
+    // Largest whole part whose cents (plus .99 and a rounding cent) fit
+    const Money maxWhole = LLONG_MAX / CENTS_PER_RINGGIT - 1;
+    Money whole = 0;
+    int digits = 0;
+    for(; i < end && isdigit((unsigned char)text[i]); i++, digits++) {
+        int digit = text[i] - '0';
+        if(whole > (maxWhole - digit) / 10) {
+            throw out_of_range("parseMoney: " + text);
         }
-        result = intPart[i] + result;
-        count++;
+        whole = whole * 10 + digit;
     }
-    
-    return result + decPart;
+    Money fraction = 0;
+    int fractionDigits = 0;
+    bool roundUp = false;
+    if(i < end && text[i] == '.') {
+        for(i++; i < end && isdigit((unsigned char)text[i]); i++, digits++) {
+            if(fractionDigits < 2) {
+                fraction = fraction * 10 + (text[i] - '0');
+                fractionDigits++;
+            } else if(fractionDigits == 2) {
+                roundUp = (text[i] >= '5');
+                fractionDigits++;
+            }
+        }
+    }
+    if(digits == 0 || i != end) {
+        throw invalid_argument("parseMoney: " + text);
+    }
+    for(; fractionDigits < 2; fractionDigits++) {
+        fraction *= 10;
+    }
+    Money cents = whole * CENTS_PER_RINGGIT + fraction + (roundUp ? 1 : 0);
+    return negative ? -cents : cents;
+}
+
+// True if a typed amount (or count) converts to cents without overflow;
+// false for NaN too
+bool moneyInputInRange(double amount) {
+    return fabs(amount) < (double)(LLONG_MAX / CENTS_PER_RINGGIT);
+}
+
+// Rounds a typed RM amount to cents (menu input only; data files go
+// through parseMoney). Callers check moneyInputInRange first.
+Money toCents(double amount) {
+    if(!moneyInputInRange(amount)) {
+        throw out_of_range("toCents: amount too large");
+    }
+    return llround(amount * CENTS_PER_RINGGIT);
 }
@@ -28,7 +28,7 @@ if exist osoms.exe (
 )
 
 REM Compile the program
-g++ -o OSOMS.exe main.cpp -std=c++11
+g++ -o OSOMS.exe main.cpp -std=c++11 -pthread
 
 REM Check if compilation was successful
 if %errorlevel% equ 0 (